@@ -4,59 +4,131 @@
 
 #include "SerLCD0.h"
 
+// HD44780 memory offset for each row
+static const uint8_t row_offsets[] = { 0x00, 0x40, 0x14, 0x54 };
+
+// Orders ring contents against head/tail publication for the other context
+static inline void queueBarrier() {
+    __sync_synchronize();
+}
+
 // Static member initialization with explanatory comments
 // Controls debug message output to Serial monitor - disabled by default for production use
-bool SerLCD0::_SerLCD0_Debug = false;               
+bool SerLCD0Base::_SerLCD0_Debug = false;               
 
 // Sets threshold for errors before triggering reset - defaults to 1 for quick recovery
-uint8_t SerLCD0::_SerLCD0_ErrorThreshold = 1;       
+uint8_t SerLCD0Base::_SerLCD0_ErrorThreshold = 1;       
 
-// Constructor for SerLCD0 class - initializes display interface and state
-SerLCD0::SerLCD0(TwoWire &wirePort, uint8_t i2c_addr) {
-    _wirePort = &wirePort;         // Store reference to I2C interface object
-    _i2cAddr = i2c_addr;           // Store display's I2C address (default 0x72)
+// Constructor for SerLCD0 class - initializes storage and state, SerLCD0T owns the transport
+SerLCD0Base::SerLCD0Base(uint8_t* queue, uint32_t* stamps, uint16_t queueSize,
+                         char* frame, char* panel, uint8_t cols, uint8_t rows,
+                         SerLCD0Log::Record* log) {
+    _queue = queue;                // Store queue storage supplied by SerLCD0T
+    _stamps = stamps;              // Enqueue times and histograms, nullptr unless latency stats are on
+    static_assert(LATENCY_WORDS == URGENT_QUEUE_SIZE + 2 * WIRE_BUFFER_SIZE + 4 * LATENCY_BUCKETS,
+                  "LATENCY_WORDS must cover the urgent lane, both batches and the histograms");
+    _queueMask = queueSize - 1;    // Power-of-two size wraps with a mask
+    _frame = frame;                // Store shadow buffer storage
+    _panel = panel;
+    _maxCols = cols;               // Shadow buffer geometry
+    _maxRows = rows;
     _state = State::READY;         // Initialize state machine to ready state
     _queueHead = 0;                // Initialize queue read position to start
     _queueTail = 0;                // Initialize queue write position to start
+    _lastFrame = 0;                // No frame queued yet
+    _urgentHead = 0;               // Urgent lane empty
+    _urgentTail = 0;
+    _overflowPolicy = OverflowPolicy::DROP_NEWEST;  // Full queue refuses new commands
+    _overflowCount = 0;            // Nothing dropped yet
+    _queueMode = QueueMode::SINGLE_CONTEXT;  // Everything from loop() until told otherwise
+    _initPending = false;          // Initialization is queued by reinitialize()
+    _lockProducers = false;        // One producer needs no lock
     _errorCount = 0;               // Initialize error counter to zero
     _needsFullRefresh = true;      // Set flag to perform full display refresh on first update
+    _shadowEnabled = false;        // Queue writes directly until shadow buffer enabled
+    _shadowDirty = false;
+    _cols = cols;                  // Default to full shadow buffer geometry
+    _rows = rows;
+    _cursorCol = 0;                // Local cursor at home position
+    _cursorRow = 0;
+    _panelCol = 0;                 // Panel cursor homed by initial clear
+    _panelRow = 0;
+    _bytesSaved = 0;               // No cursor commands avoided yet
+    _fieldCount = 0;               // No field slots defined
+    _dirtyFields = 0;
+    _staleFields = 0;
+    _txBuf = _batchStorage[0];     // Batches alternate between the two buffers
+    _nextBuf = _batchStorage[1];
+    _txLen = 0;                    // No batch taken off the queue
+    _txSettle = 0;
+    _txAbandoned = false;          // Transport holds no timed-out batch
+    _nextLen = 0;                  // Nothing staged
+    _nextSettle = 0;
+    _log = log;                    // Debug event ring, nullptr if the sketch compiled it out
+    _logHead = 0;                  // Debug event ring empty
+    _logTail = 0;
+    _logLost = 0;
+    resetLatencyStats();           // Histograms empty
 }
 
-// Initialize display with specified Wire interface
-void SerLCD0::begin(TwoWire &wirePort) {
-    _wirePort = &wirePort;         // Update Wire interface pointer
+// Initialize display over the transport SerLCD0T was constructed with
+void SerLCD0Base::begin() {
     reinitialize();                // Perform full display reinitialization
 }
 
 // Reset display to known good state
-void SerLCD0::reinitialize() {
+void SerLCD0Base::reinitialize() {
     resetQueue();                  // Clear any pending commands from queue
     _state = State::PROCESSING;    // Set state to processing during init
-    _lastActionTime = millis();    // Record initialization start time
+    _lastActionMicros = micros();  // Record initialization start time
+    _settleMicros = _initTime;     // Give display its initialization time before first batch
     _errorCount = 0;               // Reset the error counter
     _needsFullRefresh = true;      // Mark display for full refresh
     
+    // Only the producer may queue in LOCK_FREE_SPSC mode, so update() sends it directly
+    if(!rewritesQueue()) {
+        _initPending = true;
+        return;
+    }
+    
     // Queue basic initialization sequence
-    clear();                       // Queue display clear command
+    clearPanel();                  // Queue display clear command
     setBacklight(255, 255, 255);   // Queue white backlight command
 }
 
+// Choose queue mode, call before a second context starts queueing
+void SerLCD0Base::setQueueMode(QueueMode mode) {
+    _queueMode = mode;
+    _lockProducers = (mode == QueueMode::LOCKED_MPSC);
+    if(!rewritesQueue()) {
+        _shadowEnabled = false;    // Shadow flushes would make update() a second producer
+        clearFields();             // And so would field flushes
+    }
+}
+
 // Main update function - handles state machine and command processing
-bool SerLCD0::update() {
-    unsigned long currentTime = millis();    // Get current time for timing checks
+bool SerLCD0Base::update() {
+    unsigned long currentTime = micros();    // Get current time for timing checks
     
     // State machine implementation
     switch(_state) {
         case State::PROCESSING:
-            // Check if minimum command processing time has elapsed
-            if(currentTime - _lastActionTime >= _cmdTime) {
+            // Check if last transaction's settle time has elapsed
+            if(currentTime - _lastActionMicros >= _settleMicros) {
                 _state = State::READY;       // Return to ready state if time elapsed
             }
             break;
             
+        case State::AWAITING_RESPONSE:
+            // Settle time starts once the batch is out, meanwhile encode the next one
+            if(checkTransfer() && _state == State::AWAITING_RESPONSE) {
+                stageNext();
+            }
+            break;
+            
         case State::ERROR:
             // Check if error recovery time has elapsed
-            if(currentTime - _lastActionTime >= _errorResetTime) {
+            if(currentTime - _lastActionMicros >= _errorResetTime) {
                 _state = State::READY;       // Return to ready state
                 _errorCount = 0;             // Reset error counter
                 reinitialize();              // Attempt display reinitialization
@@ -64,133 +136,596 @@ bool SerLCD0::update() {
             return false;                    // Indicate not ready while in error state
             
         case State::READY:
+            // Send changed shadow cells or fields once earlier commands have drained
+            if(_queueHead == _queueTail) {
+                flushLocalChanges();
+            }
+            
             // Process next queued command if available
-            if(_queueHead != _queueTail) {   // Check if queue contains commands
+            if(hasPending()) {               // Check if queue contains commands
                 return processNextCommand();  // Process next command in queue
             }
+            drainLog();                      // Idle, debug output delays nothing
             break;
     }
     
     return (_state == State::READY);         // Return true if in ready state
 }
 
-// Calculate current number of commands in queue
-uint8_t SerLCD0::getQueueCount() const {
-    // Handle queue wrap-around when calculating size
-    return (_queueTail >= _queueHead) ? 
-        _queueTail - _queueHead :            // Simple case: tail after head
-        QUEUE_SIZE - (_queueHead - _queueTail); // Wrapped case: tail before head
+// Time-budgeted update - keeps sending batches for up to budgetMicros, waiting out
+// settle times that end within the budget and returning early when one does not.
+// A blocking transport runs a batch started inside the slice to completion, while an
+// asynchronous one in flight hands the rest of the slice back
+bool SerLCD0Base::update(unsigned long budgetMicros) {
+    unsigned long start = micros();          // Start of this time slice
+    
+    while(micros() - start < budgetMicros) {
+        if(_state == State::ERROR) {
+            return update();                 // Error recovery is the same as a single pass
+        }
+        
+        if(_state == State::AWAITING_RESPONSE) {
+            if(!checkTransfer()) {
+                break;                       // Failed or timed out
+            }
+            if(_state == State::AWAITING_RESPONSE) {
+                stageNext();                 // Still on the bus without our help
+                break;
+            }
+        }
+        
+        if(_state == State::PROCESSING) {
+            unsigned long waited = micros() - _lastActionMicros;
+            if(waited < _settleMicros) {
+                if(!hasWork()) {
+                    break;                   // Nothing to send once settled, keep the slice
+                }
+                unsigned long left = budgetMicros - (micros() - start);
+                if(_settleMicros - waited > left) {
+                    break;                   // Display still settling after this slice
+                }
+                yield();                     // Settle ends within slice, wait for it
+                continue;
+            }
+            _state = State::READY;
+        }
+        
+        // Send changed shadow cells or fields once earlier commands have drained
+        if(_queueHead == _queueTail) {
+            flushLocalChanges();
+        }
+        if(!hasPending()) {
+            drainLog();                      // Idle, debug output delays nothing
+            break;                           // Nothing left to send
+        }
+        if(!processNextCommand()) {
+            break;                           // Send failed
+        }
+    }
+    
+    return (_state == State::READY);         // Return true if in ready state
+}
+
+// Calculate current number of encoded bytes in queue
+uint16_t SerLCD0Base::getQueueCount() const {
+    // Mask handles queue wrap-around when tail is before head
+    return (_queueTail - _queueHead) & _queueMask;
 }
 
 // Calculate queue fullness as percentage
-float SerLCD0::getQueuePercentFull() const {
+float SerLCD0Base::getQueuePercentFull() const {
     // Convert current queue count to percentage of total capacity
-    return (getQueueCount() * 100.0) / QUEUE_SIZE;
+    return (getQueueCount() * 100.0) / getQueueSize();
 }
 
-// Add new command to queue
-bool SerLCD0::queueCommand(const LCDCommand& cmd) {
-    // Calculate next queue position with wrap-around
-    uint8_t nextTail = (_queueTail + 1) % QUEUE_SIZE;
+// Add encoded command frame to queue, all bytes or none
+bool SerLCD0Base::queueBytes(const uint8_t* data, uint8_t len) {
+    lockQueue();
+    bool queued = storeFrame(data, len);
+    unlockQueue();
+    return queued;
+}
+
+// Add encoded command frame to the urgent lane, all bytes or none
+bool SerLCD0Base::queueUrgent(const uint8_t* data, uint8_t len) {
+    lockQueue();
+    
+    // An older command of the same kind must not undo this one after it jumps ahead,
+    // so pending ones in either lane, or in the batch staged behind a transfer, take the new value
+    bool merged = false;
+    if(rewritesQueue()) {
+        rewriteSameKind(_queue, _queueMask, _queueHead, _queueTail, data, len);
+        rewriteSameKind(_nextBuf, 0xFF, 0, _nextLen, data, len);  // Linear buffer, never wraps
+        merged = rewriteSameKind(_urgent, URGENT_MASK, _urgentHead, _urgentTail, data, len);
+    }
+    
+    bool queued = true;
+    if(!merged) {
+        uint16_t tail = _urgentTail;
+        queueBarrier();            // Slots freed by update() are no longer being read
+        if(((_urgentHead - tail - 1) & URGENT_MASK) < len) {
+            _overflowCount++;      // Urgent lane full, count the refused frame
+            queued = false;
+        } else {
+            for(uint8_t i = 0; i < len; i++) {
+                _urgent[(tail + i) & URGENT_MASK] = data[i];
+            }
+            if(timing()) {
+                urgentStamps()[tail] = micros();  // Wait starts now
+            }
+            queueBarrier();        // Frame bytes visible before the new tail
+            _urgentTail = (tail + len) & URGENT_MASK;
+        }
+    }
     
-    // Check for queue full condition
-    if(nextTail == _queueHead) {
-        handleError();             // Trigger error handling for full queue
+    unlockQueue();
+    return queued;
+}
+
+// Overwrite pending frames in a lane that set the same thing as data, returns true if any did
+bool SerLCD0Base::rewriteSameKind(uint8_t* ring, uint16_t mask, uint16_t head, uint16_t tail,
+                                  const uint8_t* data, uint8_t len) {
+    bool found = false;
+    LCDCommand::Type type = frameType(data[0], data[1]);
+    for(uint16_t index = head; index != tail; ) {
+        uint8_t n = frameLength(ring, mask, index);
+        uint8_t first = ring[index];
+        uint8_t second = n > 1 ? ring[(index + 1) & mask] : 0;  // A plain character may end the buffer
+        if(n == len && frameType(first, second) == type &&
+           (type == LCDCommand::RGB_CMD || (isDisplayCommand(second) && isDisplayCommand(data[1])))) {
+            for(uint8_t i = 1; i < len; i++) {
+                ring[(index + i) & mask] = data[i];
+            }
+            found = true;
+        }
+        index = (index + n) & mask;
+    }
+    return found;
+}
+
+// Add encoded command frame to queue, caller holds the queue lock
+bool SerLCD0Base::storeFrame(const uint8_t* data, uint8_t len) {
+    // Merge into a pending frame this one supersedes
+    if(coalesceFrame(data, len)) {
+        return true;               // No new queue space used
+    }
+    
+    // Check for queue full condition, not a bus error so the display keeps running
+    if(!makeRoom(len)) {
+        _overflowCount++;          // Count the refused frame
+        if (producerLogging(SerLCD0Log::QUEUE)) {
+            logEvent(SerLCD0Log::QUEUE_FULL, len);
+        }
         return false;              // Indicate command not queued
     }
     
-    // Add command to queue and update tail position
-    _cmdQueue[_queueTail] = cmd;   // Store command in queue
-    _queueTail = nextTail;         // Update queue write position
+    // Copy frame into ring with wrap-around, then publish it by moving the tail
+    uint16_t tail = _queueTail;
+    queueBarrier();                // Slots freed by update() are no longer being read
+    for(uint8_t i = 0; i < len; i++) {
+        _queue[(tail + i) & _queueMask] = data[i];
+    }
+    if(timing()) {
+        _stamps[tail] = micros();  // Wait starts now, a coalesced frame keeps its first time
+    }
+    _lastFrame = tail;             // Remember frame start for coalescing
+    queueBarrier();                // Frame bytes visible before the new tail
+    _queueTail = (tail + len) & _queueMask;
     
     return true;                   // Indicate successful queue
 }
 
-// Process the next command in queue
-bool SerLCD0::processNextCommand() {
-    // Verify state and queue not empty
-    if(_state != State::READY || _queueHead == _queueTail) {
-        return false;              // Return false if not ready or queue empty
+// Make sure bytes of queue space are free, dropping the oldest frames if the policy allows.
+// The shadow buffer tracks what queued text will show, so it never drops old frames
+bool SerLCD0Base::makeRoom(uint16_t bytes) {
+    if(getQueueFree() >= bytes) {
+        return true;               // Already fits
+    }
+    if(_overflowPolicy != OverflowPolicy::DROP_OLDEST || _shadowEnabled || !rewritesQueue() ||
+       bytes > _queueMask) {
+        return false;              // Caller's frame is dropped instead
     }
     
-    // Get command at current queue position
-    LCDCommand& cmd = _cmdQueue[_queueHead];
+    // Unsent frames at the head have not reached the display yet
+    while(getQueueFree() < bytes) {
+        _queueHead = (_queueHead + frameLength(_queueHead)) & _queueMask;
+        _overflowCount++;
+    }
+    _needsFullRefresh = true;      // Display misses the dropped content
+    _staleFields = (1 << _fieldCount) - 1;  // Dropped frames may have carried field text
+    _dirtyFields = _staleFields;
+    return true;
+}
+
+// Make sure the next bytes of encoded commands will be queued
+bool SerLCD0Base::reserve(uint16_t bytes) {
+    return makeRoom(bytes);
+}
+
+// Print a string only if all of it can be queued, returns characters written or 0
+size_t SerLCD0Base::tryPrint(const char* str) {
+    size_t size = strlen(str);
+    if(_shadowEnabled) {
+        return write((const uint8_t*)str, size);
+    }
     
-    // Attempt to send command to display
-    if(sendCommand(cmd)) {
-        _queueHead = (_queueHead + 1) % QUEUE_SIZE;  // Update queue read position
-        _state = State::PROCESSING;                   // Enter processing state
-        _lastActionTime = millis();                   // Record command start time
-        return true;                                  // Indicate successful processing
+    size_t bytes = textBytes((const uint8_t*)str, size);
+    lockQueue();
+    size_t count = 0;              // Nothing queued unless all of it fits
+    if(bytes <= _queueMask && makeRoom(bytes)) {
+        count = storeText((const uint8_t*)str, size);
+    } else {
+        _overflowCount += size;    // Count the refused characters
+    }
+    unlockQueue();
+    return count;
+}
+
+// Queue a cursor move and text as one unit, so another producer cannot
+// slip its own commands in between. Returns false and queues nothing if it does not fit
+bool SerLCD0Base::writeField(uint8_t col, uint8_t row, const char* text) {
+    size_t size = strlen(text);
+    if(_shadowEnabled) {
+        setCursor(col, row);
+        write((const uint8_t*)text, size);
+        return true;
     }
     
-    handleError();                 // Handle command transmission failure
-    return false;                  // Indicate processing failure
+    uint8_t cursor[CURSOR_CMD_BYTES] = { SPECIAL_COMMAND, cursorCommand(col, row) };
+    size_t bytes = CURSOR_CMD_BYTES + textBytes((const uint8_t*)text, size);
+    lockQueue();
+    bool fits = (bytes <= _queueMask && makeRoom(bytes));
+    if(fits) {
+        storeFrame(cursor, CURSOR_CMD_BYTES);  // Only update() runs meanwhile, so the text
+        storeText((const uint8_t*)text, size); // still fits after the cursor move
+    } else {
+        _overflowCount += size + 1;  // Count the refused cursor move and characters
+    }
+    unlockQueue();
+    return fits;
+}
+
+// Encoded size of a run of characters including escapes
+size_t SerLCD0Base::textBytes(const uint8_t* text, size_t size) {
+    size_t bytes = 0;
+    for(size_t i = 0; i < size; i++) {
+        bytes += charBytes(text[i]);
+    }
+    return bytes;
 }
 
-// Send command to display via I2C
-bool SerLCD0::sendCommand(const LCDCommand& cmd) {
-    _wirePort->beginTransmission(_i2cAddr);  // Start I2C transmission
+// Overwrite a pending frame that the new frame supersedes, returns true if merged
+bool SerLCD0Base::coalesceFrame(const uint8_t* data, uint8_t len) {
+    if(len < 2 || !rewritesQueue()) {
+        return false;              // Plain characters never supersede anything
+    }
+    LCDCommand::Type type = frameType(data[0], data[1]);
     
-    // Process command based on type
-    switch(cmd.type) {
-        case LCDCommand::WRITE_CHAR:
-            // Special handling for command characters
-            if(cmd.data[0] == SPECIAL_COMMAND || cmd.data[0] == SETTING_COMMAND) {
-                _wirePort->write(cmd.data[0]);  // Send character twice to escape
+    // Newer backlight colour replaces any pending one wherever it sits in the queue
+    if(type == LCDCommand::RGB_CMD) {
+        for(uint16_t index = _queueHead; index != _queueTail; ) {
+            uint8_t n = frameLength(index);
+            if(n == MAX_CMD_BYTES) {
+                for(uint8_t i = 2; i < MAX_CMD_BYTES; i++) {
+                    _queue[(index + i) & _queueMask] = data[i];
+                }
+                return true;
             }
-            _wirePort->write(cmd.data[0]);      // Send character
-            break;
+            index = (index + n) & _queueMask;
+        }
+        return false;
+    }
+    
+    // Cursor moves and display on/off only replace the frame queued just before them,
+    // so noDisplay()/print()/display() still hides a redraw
+    if(type != LCDCommand::SPECIAL_CMD || !lastFramePending()) {
+        return false;
+    }
+    uint8_t first = _queue[_lastFrame];
+    uint8_t second = _queue[(_lastFrame + 1) & _queueMask];
+    if(frameLength(_lastFrame) != 2 || frameType(first, second) != LCDCommand::SPECIAL_CMD) {
+        return false;
+    }
+    if((isPositionCommand(second) && isPositionCommand(data[1])) ||
+       (isDisplayCommand(second) && isDisplayCommand(data[1]))) {
+        _queue[(_lastFrame + 1) & _queueMask] = data[1];
+        return true;
+    }
+    return false;
+}
+
+// Check if the most recently queued frame has not been sent yet
+bool SerLCD0Base::lastFramePending() const {
+    return ((_lastFrame - _queueHead) & _queueMask) < getQueueCount();
+}
+
+// Drop pending text, cursor and clear frames made pointless by a new clear
+void SerLCD0Base::discardPendingText() {
+    if(!rewritesQueue()) {
+        return;                    // Frames may already be in update()'s hands
+    }
+    uint16_t read = _queueHead;    // Next frame to examine
+    uint16_t keep = _queueHead;    // End of frames kept so far
+    
+    while(read != _queueTail) {
+        uint8_t n = frameLength(read);
+        bool kept = false;
+        if(n > 1) {
+            uint8_t first = _queue[read];
+            uint8_t second = _queue[(read + 1) & _queueMask];
+            LCDCommand::Type type = frameType(first, second);
+            kept = (type == LCDCommand::RGB_CMD || type == LCDCommand::SETTING_CMD ||
+                    (type == LCDCommand::SPECIAL_CMD && isDisplayCommand(second)));
+        }
+        
+        // Slide kept frames down over the discarded ones
+        if(kept) {
+            for(uint8_t i = 0; i < n; i++) {
+                _queue[(keep + i) & _queueMask] = _queue[(read + i) & _queueMask];
+            }
+            if(timing()) {
+                _stamps[keep] = _stamps[read];  // Frame keeps its enqueue time
+            }
+            keep = (keep + n) & _queueMask;
+        }
+        read = (read + n) & _queueMask;
+    }
+    
+    _queueTail = keep;
+    _lastFrame = keep;             // Previous frame position no longer valid
+}
+
+// Start sending the next batch of commands, a batch that failed is retried first
+bool SerLCD0Base::processNextCommand() {
+    // Verify state and queue not empty
+    if(_state != State::READY || !hasPending()) {
+        return false;              // Return false if not ready or queue empty
+    }
+    
+    // A timed-out transfer may still be reading _txBuf, so neither buffer is
+    // touched until the transport lets go of it
+    if(_txAbandoned) {
+        if(pollSend() == TransferStatus::BUSY) {
+            return false;          // Check again on a later update()
+        }
+        _txAbandoned = false;
+    }
+    
+    if(_txLen == 0) {
+        stageBatch();              // Take the next batch off the queue
+    }
+    unsigned long start = micros();  // Blocking transports return after the transfer
+    if(!transmit()) {
+        handleError();             // Handle command transmission failure
+        return false;              // Indicate processing failure
+    }
+    _state = State::AWAITING_RESPONSE;  // Batch is on the bus
+    _lastActionMicros = start;     // Record transfer start for the timeout and latency stats
+    return checkTransfer();        // Blocking transports have already finished
+}
+
+// Poll the batch in flight, the display's settle time starts once it is out.
+// A transfer that never finishes counts as a failed one
+bool SerLCD0Base::checkTransfer() {
+    TransferStatus status = pollSend();
+    if(status == TransferStatus::BUSY && micros() - _lastActionMicros >= _transferTimeout) {
+        if (logging(SerLCD0Log::BUS)) {
+            logEvent(SerLCD0Log::TRANSFER_TIMEOUT, _txLen);
+        }
+        _txAbandoned = true;       // Transport may still be reading _txBuf
+        status = TransferStatus::FAILED;
+    }
+    
+    switch(status) {
+        case TransferStatus::BUSY:
+            return true;           // Check again on a later update()
             
-        case LCDCommand::SPECIAL_CMD:
-            _wirePort->write(SPECIAL_COMMAND);   // Send special command prefix
-            _wirePort->write(cmd.data[0]);       // Send command byte
-            break;
+        case TransferStatus::DONE:
+            recordLatency(_lastActionMicros);           // Waits ended when the transfer started
+            _txLen = 0;            // Batch delivered
+            _settleMicros = _txSettle;                  // Display acts on it from now
+            _state = State::PROCESSING;                 // Enter processing state
+            _lastActionMicros = micros();               // Record command end time
+            return true;                                // Indicate successful processing
             
+        default:
+            _state = State::READY; // Batch stays in _txBuf for a retry
+            handleError();
+            return false;
+    }
+}
+
+// Make the next batch the one in _txBuf, urgent lane first, freeing its queue space.
+// Urgent commands never move the cursor, so sending them between normal batches
+// (or ahead of one already staged) cannot misplace text
+void SerLCD0Base::stageBatch() {
+    if(_initPending) {
+        stageInit();
+        _initPending = false;
+    } else if(_urgentHead != _urgentTail) {
+        _txLen = gatherBatch(_urgent, URGENT_MASK, _urgentHead, _urgentTail, _txBuf, _txSettle);
+        copyStamps(urgentStamps(), URGENT_MASK, _urgentHead, _txBuf, _txLen);
+        queueBarrier();                                 // Batch copied before slots are freed
+        _urgentHead = (_urgentHead + _txLen) & URGENT_MASK;
+    } else if(_nextLen != 0) {
+        uint8_t* buf = _txBuf;                          // Staged batch is ready to go
+        _txBuf = _nextBuf;
+        _nextBuf = buf;
+        _txLen = _nextLen;
+        _txSettle = _nextSettle;
+        _nextLen = 0;
+    } else {
+        _txLen = gatherBatch(_queue, _queueMask, _queueHead, _queueTail, _txBuf, _txSettle);
+        copyStamps(_stamps, _queueMask, _queueHead, _txBuf, _txLen);
+        queueBarrier();                                 // Batch copied before slots are freed
+        _queueHead = (_queueHead + _txLen) & _queueMask;  // Update queue read position
+    }
+}
+
+// Encode the next normal batch while the current one is on the bus, so it can be
+// started as soon as the display has settled
+void SerLCD0Base::stageNext() {
+    if(_nextLen != 0 || _queueHead == _queueTail) {
+        return;                                         // Already staged, or nothing to stage
+    }
+    _nextLen = gatherBatch(_queue, _queueMask, _queueHead, _queueTail, _nextBuf, _nextSettle);
+    copyStamps(_stamps, _queueMask, _queueHead, _nextBuf, _nextLen);
+    queueBarrier();                                     // Batch copied before slots are freed
+    _queueHead = (_queueHead + _nextLen) & _queueMask;
+}
+
+// Length of the encoded frame starting at a ring position
+uint8_t SerLCD0Base::frameLength(const uint8_t* ring, uint16_t mask, uint16_t index) {
+    uint8_t first = ring[index & mask];
+    if(first != SPECIAL_COMMAND && first != SETTING_COMMAND) {
+        return 1;                               // Plain character
+    }
+    uint8_t second = ring[(index + 1) & mask];
+    if(first == SETTING_COMMAND && second == RGB_COMMAND) {
+        return 5;                               // Prefix, RGB command, red, green, blue
+    }
+    return 2;                                   // Prefixed command or escaped character
+}
+
+// Classify an encoded frame by its first two bytes
+LCDCommand::Type SerLCD0Base::frameType(uint8_t first, uint8_t second) {
+    if(first != SPECIAL_COMMAND && first != SETTING_COMMAND) {
+        return LCDCommand::WRITE_CHAR;          // Plain character
+    }
+    if(second == first) {
+        return LCDCommand::WRITE_CHAR;          // Escaped command character
+    }
+    if(first == SPECIAL_COMMAND) {
+        return LCDCommand::SPECIAL_CMD;
+    }
+    return (second == RGB_COMMAND) ? LCDCommand::RGB_CMD : LCDCommand::SETTING_CMD;
+}
+
+// Time the display needs to act on a multi-byte frame (microseconds)
+unsigned long SerLCD0Base::settleBudget(uint8_t first, uint8_t second) const {
+    switch(frameType(first, second)) {
+        case LCDCommand::WRITE_CHAR:
+            return _charTime;                   // Escaped command character
+        case LCDCommand::SPECIAL_CMD:
+            return second == CLEAR_COMMAND ? _clearTime : _cmdTime;
         case LCDCommand::SETTING_CMD:
-            _wirePort->write(SETTING_COMMAND);   // Send settings command prefix
-            _wirePort->write(cmd.data[0]);       // Send setting byte
-            break;
-            
+            return _settingTime;                // Settings are saved to EEPROM
         case LCDCommand::RGB_CMD:
-            // Debug output for RGB values if enabled
-            if (_SerLCD0_Debug) {
-                Serial.println("Setting backlight RGB:");
-                Serial.print(cmd.data[0]); Serial.print(",");
-                Serial.print(cmd.data[1]); Serial.print(",");
-                Serial.println(cmd.data[2]);
-            }
-            
-            // Send RGB command sequence
-            _wirePort->write(SETTING_COMMAND);   // Settings mode prefix
-            _wirePort->write(RGB_COMMAND);       // RGB control command
-            _wirePort->write(cmd.data[0]);       // Red value (0-255)
-            _wirePort->write(cmd.data[1]);       // Green value (0-255)
-            _wirePort->write(cmd.data[2]);       // Blue value (0-255)
-            break;
-            
+            return _rgbTime;
         default:
-            return false;                        // Invalid command type
+            return _cmdTime;
     }
+}
+
+// Commands the display needs time to act on before accepting more bytes
+bool SerLCD0Base::endsBatch(uint8_t first, uint8_t second) const {
+    LCDCommand::Type type = frameType(first, second);
+    return type == LCDCommand::SETTING_CMD ||
+           type == LCDCommand::RGB_CMD ||
+           (type == LCDCommand::SPECIAL_CMD && second == CLEAR_COMMAND);
+}
+
+// Copy consecutive frames from a lane into buf as one transaction, returns its length
+// and sets settle to the time the display needs for it (microseconds).
+// tail is the lane's published tail, read once by the caller
+uint8_t SerLCD0Base::gatherBatch(const uint8_t* ring, uint16_t mask, uint16_t head, uint16_t tail,
+                                 uint8_t* buf, unsigned long& settle) {
+    uint16_t index = head;                      // Lane position being copied
+    uint8_t len = 0;
+    settle = 0;
+    queueBarrier();                             // Read frames only after their tail
     
-    // Complete I2C transmission and check result
-    bool success = (_wirePort->endTransmission() == 0);
-    if (_SerLCD0_Debug && !success) {
-        Serial.println("I2C transmission failed");
+    // Gather whole frames until the Wire TX buffer would overflow
+    while(index != tail) {
+        uint8_t n = frameLength(ring, mask, index);
+        if(len + n > WIRE_BUFFER_SIZE) {
+            break;                              // Batch full
+        }
+        for(uint8_t i = 0; i < n; i++) {
+            buf[len + i] = ring[(index + i) & mask];
+        }
+        index = (index + n) & mask;
+        
+        // Debug output for RGB values if enabled
+        if (logging(SerLCD0Log::BACKLIGHT) && n == MAX_CMD_BYTES) {
+            logEvent(SerLCD0Log::BACKLIGHT_SENT, buf[len + 2], buf[len + 3], buf[len + 4]);
+        }
+        
+        len += n;
+        if(n == 1) {
+            settle += _charTime;                // Plain character
+            continue;
+        }
+        settle += settleBudget(buf[len - n], buf[len - n + 1]);
+        if(endsBatch(buf[len - n], buf[len - n + 1])) {
+            break;                              // Let display settle before continuing
+        }
     }
-    return success;                             // Return transmission result
+    
+    return len;                                 // Display waits the summed budget of every command
+}
+
+// Stage the clear and white backlight that reinitialize() would otherwise queue
+void SerLCD0Base::stageInit() {
+    static const uint8_t init[] = {
+        SPECIAL_COMMAND, CLEAR_COMMAND,         // Clear display
+        SETTING_COMMAND, RGB_COMMAND, 255, 255, 255  // White backlight
+    };
+    memcpy(_txBuf, init, sizeof(init));
+    _txLen = sizeof(init);
+    _txSettle = _clearTime + _rgbTime;
+    copyStamps(nullptr, 0, 0, _txBuf, _txLen);  // Counts as queued now
+}
+
+// Copy the enqueue times of a batch just gathered from a lane starting at head,
+// before the lane's slots are freed. No stamps means the batch was made just now
+void SerLCD0Base::copyStamps(const uint32_t* stamps, uint16_t mask, uint16_t head,
+                             const uint8_t* buf, uint8_t len) {
+    if(!timing()) {
+        return;
+    }
+    uint32_t* to = batchStamps(buf);
+    uint32_t now = micros();
+    for(uint8_t i = 0; i < len; i++) {
+        to[i] = stamps ? stamps[(head + i) & mask] : now;  // Only frame starts are read
+    }
+}
+
+// Add each command in the delivered _txBuf to its type's histogram
+void SerLCD0Base::recordLatency(unsigned long sent) {
+    if(!timing()) {
+        return;
+    }
+    const uint32_t* stamps = batchStamps(_txBuf);
+    for(uint8_t i = 0; i < _txLen; ) {
+        uint8_t n = frameLength(_txBuf, WIRE_BUFFER_SIZE - 1, i);
+        LCDCommand::Type type = frameType(_txBuf[i], n > 1 ? _txBuf[i + 1] : 0);
+        uint32_t wait = (uint32_t)sent - stamps[i];  // Wrap-safe like the other timings
+        uint8_t bucket = 0;
+        while(bucket < LATENCY_BUCKETS - 1 && wait >= getLatencyLimit(bucket)) {
+            bucket++;
+        }
+        latencyCounts(type)[bucket]++;
+        i += n;
+    }
+}
+
+// Hand _txBuf to the transport as a single transaction, one call per batch
+bool SerLCD0Base::transmit() {
+    bool success = startSend(_txBuf, _txLen);   // Transport policy in SerLCD0T
+    if (logging(SerLCD0Log::BUS) && !success) {
+        logEvent(SerLCD0Log::TRANSFER_FAILED, _txLen);
+    }
+    return success;
 }
 
 // Handle error conditions
-void SerLCD0::handleError() {
+void SerLCD0Base::handleError() {
     _errorCount++;                              // Increment error counter
     
     // Output debug information if enabled and at/above threshold
-    if (_SerLCD0_Debug && _errorCount >= _SerLCD0_ErrorThreshold) {
-        Serial.print("Error #");
-        Serial.print(_errorCount);
-        Serial.print(" in state: ");
-        Serial.println(getStateString());
+    if (logging(SerLCD0Log::RECOVERY) && _errorCount >= _SerLCD0_ErrorThreshold) {
+        logEvent(SerLCD0Log::ERROR_COUNTED, _errorCount, static_cast<uint8_t>(_state));
     }
     
     // Check if error threshold exceeded
@@ -199,91 +734,486 @@ void SerLCD0::handleError() {
         _needsFullRefresh = true;               // Mark for full refresh
         resetQueue();                           // Clear command queue
         
-        if (_SerLCD0_Debug) {
-            Serial.println("ERROR state - will reset");
+        if (logging(SerLCD0Log::RECOVERY)) {
+            logEvent(SerLCD0Log::ERROR_STATE, _errorCount);
+        }
+    }
+    _lastActionMicros = micros();               // Record error time
+}
+
+// Record a debug event in the log ring, a full ring counts it as lost
+void SerLCD0Base::logEvent(uint8_t id, uint8_t a, uint8_t b, uint8_t c) {
+    if(SerLCD0Log::MASK == 0 || _log == nullptr) {
+        return;                                 // Logging compiled out
+    }
+    uint8_t next = (_logTail + 1) & LOG_MASK;
+    if(next == _logHead) {
+        if(_logLost < 255) {
+            _logLost++;                         // Reported once the ring drains
+        }
+        return;
+    }
+    SerLCD0Log::Record& record = _log[_logTail];
+    record.micros = micros();
+    record.id = id;
+    record.a = a;
+    record.b = b;
+    record.c = c;
+    _logTail = next;
+}
+
+// Write logged events to Serial as hex lines, only while its transmit buffer
+// has room for a whole line so update() never waits on the UART
+void SerLCD0Base::drainLog() {
+    if(SerLCD0Log::MASK == 0 || _log == nullptr) {
+        return;                                 // Logging compiled out
+    }
+    static const char hex[] = "0123456789ABCDEF";
+    while(Serial.availableForWrite() >= SerLCD0Log::LINE_BYTES) {
+        SerLCD0Log::Record record;
+        if(_logHead != _logTail) {
+            record = _log[_logHead];
+            _logHead = (_logHead + 1) & LOG_MASK;
+        } else if(_logLost != 0) {
+            record = { (uint32_t)micros(), SerLCD0Log::EVENTS_LOST, _logLost, 0, 0 };
+            _logLost = 0;                       // Lost events follow what was kept
+        } else {
+            return;                             // Nothing left
+        }
+        
+        // "~" time id a b c, most significant digit first
+        char line[SerLCD0Log::LINE_BYTES];
+        uint8_t bytes[8] = {
+            (uint8_t)(record.micros >> 24), (uint8_t)(record.micros >> 16),
+            (uint8_t)(record.micros >> 8), (uint8_t)record.micros,
+            record.id, record.a, record.b, record.c
+        };
+        line[0] = '~';
+        for(uint8_t i = 0; i < 8; i++) {
+            line[1 + 2 * i] = hex[bytes[i] >> 4];
+            line[2 + 2 * i] = hex[bytes[i] & 0x0F];
         }
+        line[17] = '\r';
+        line[18] = '\n';
+        Serial.write(line, SerLCD0Log::LINE_BYTES);
     }
-    _lastActionTime = millis();                 // Record error time
 }
 
 // Reset queue to empty state
-void SerLCD0::resetQueue() {
-    _queueHead = 0;                            // Reset queue read position
-    _queueTail = 0;                            // Reset queue write position
+void SerLCD0Base::resetQueue() {
+    _queueHead = _queueTail;                   // Drop everything published, tail stays the producer's
+    _urgentHead = _urgentTail;
+    _txLen = 0;                                // Batch awaiting a retry goes too
+    _nextLen = 0;                              // And one staged behind it
 }
 
 // Implement Print class write function
-size_t SerLCD0::write(uint8_t b) {
-    // Create command for character write
-    LCDCommand cmd;
-    cmd.type = LCDCommand::WRITE_CHAR;         // Set type to character write
-    cmd.data[0] = b;                           // Store character
-    cmd.dataLen = 1;                           // Set data length
+size_t SerLCD0Base::write(uint8_t b) {
+    if(!_shadowEnabled) {
+        return queueChar(b) ? 1 : 0;           // Return 1 if queued, 0 if failed
+    }
+    shadowWrite(b);
+    return 1;
+}
+
+// Write a run of characters, encoding them into the queue in one pass
+// Returns how many fit, under DROP_OLDEST the newest characters always do
+size_t SerLCD0Base::write(const uint8_t* buffer, size_t size) {
+    if(_shadowEnabled) {
+        for(size_t i = 0; i < size; i++) {
+            shadowWrite(buffer[i]);
+        }
+        return size;
+    }
+    
+    lockQueue();
+    size_t count = storeText(buffer, size);
+    unlockQueue();
+    return count;
+}
+
+// Encode characters into the queue in one pass, caller holds the queue lock
+size_t SerLCD0Base::storeText(const uint8_t* buffer, size_t size) {
+    size_t count = 0;
+    if(_overflowPolicy == OverflowPolicy::DROP_OLDEST && rewritesQueue()) {
+        // Keep the tail of a run longer than the queue, then drop older frames for it
+        uint16_t bytes = 0;
+        count = size;
+        while(count > 0 && bytes + charBytes(buffer[count - 1]) <= _queueMask) {
+            bytes += charBytes(buffer[--count]);
+        }
+        _overflowCount += count;               // Start of the run is the oldest
+        makeRoom(bytes);
+    }
+    
+    uint16_t free = getQueueFree();            // Space checked once for the whole run
+    uint16_t tail = _queueTail;
+    uint32_t now = timing() ? micros() : 0;  // Enqueue time of the whole run
+    queueBarrier();                            // Slots freed by update() are no longer being read
+    while(count < size) {
+        uint8_t c = buffer[count];
+        uint8_t n = charBytes(c);
+        if(n > free) {
+            break;                             // Rest does not fit
+        }
+        _lastFrame = tail;                     // Remember frame start for coalescing
+        _queue[tail] = c;
+        if(timing()) {
+            _stamps[tail] = now;
+        }
+        if(n == 2) {
+            _queue[(tail + 1) & _queueMask] = c;  // Escape command character
+        }
+        tail = (tail + n) & _queueMask;
+        free -= n;
+        count++;
+    }
+    queueBarrier();                            // Run visible before the new tail
+    _queueTail = tail;                         // Publish whole run at once
     
-    return queueCommand(cmd) ? 1 : 0;          // Return 1 if queued, 0 if failed
+    if(count < size) {
+        _overflowCount += size - count;        // Rest of the run dropped
+        if (producerLogging(SerLCD0Log::QUEUE)) {
+            size_t dropped = size - count;
+            logEvent(SerLCD0Log::TEXT_TRUNCATED, dropped > 255 ? 255 : dropped);
+        }
+    }
+    return count;
+}
+
+// Print interface - bytes that can be written without dropping anything
+int SerLCD0Base::availableForWrite() {
+    return getQueueFree();
+}
+
+// Store character in shadow buffer, update() sends it if it changed
+void SerLCD0Base::shadowWrite(uint8_t b) {
+    if(_cursorRow < _rows && _cursorCol < _cols) {
+        _frame[_cursorRow * _cols + _cursorCol] = b;
+        _shadowDirty = true;
+    }
+    if(++_cursorCol >= _cols) {                // Wrap to start of next row
+        _cursorCol = 0;
+        _cursorRow = (_cursorRow + 1) % _rows;
+    }
 }
 
 // Queue display clear command
-void SerLCD0::clear() {
-    LCDCommand cmd;
-    cmd.type = LCDCommand::SPECIAL_CMD;        // Set type to special command
-    cmd.data[0] = CLEAR_COMMAND;               // Set clear display command
-    cmd.dataLen = 1;                           // Set data length
-    queueCommand(cmd);                         // Queue the command
+void SerLCD0Base::clear() {
+    if(_shadowEnabled) {
+        memset(_frame, ' ', _maxCols * _maxRows);  // Blank wanted content
+        _shadowDirty = true;
+        _cursorCol = 0;                        // Clear also homes the cursor
+        _cursorRow = 0;
+        return;
+    }
+    memset(_frame, ' ', _maxCols * _maxRows);  // Field values are cleared too
+    clearPanel();                              // Drop earlier writes and queue the command
 }
 
 // Queue cursor home command
-void SerLCD0::home() {
-    LCDCommand cmd;
-    cmd.type = LCDCommand::SPECIAL_CMD;        // Set type to special command
-    cmd.data[0] = HOME_COMMAND;                // Set cursor home command
-    cmd.dataLen = 1;                           // Set data length
-    queueCommand(cmd);                         // Queue the command
+void SerLCD0Base::home() {
+    if(_shadowEnabled) {
+        _cursorCol = 0;                        // Move local cursor only
+        _cursorRow = 0;
+        return;
+    }
+    queueSpecial(HOME_COMMAND);                // Queue the command
 }
 
 // Set cursor position
-void SerLCD0::setCursor(uint8_t col, uint8_t row) {
+void SerLCD0Base::setCursor(uint8_t col, uint8_t row) {
     row = min(row, (uint8_t)3);               // Limit row to 0-3 range
     
-    // HD44780 memory offset for each row
-    static const uint8_t row_offsets[] = { 0x00, 0x40, 0x14, 0x54 };
+    if(_shadowEnabled) {
+        _cursorCol = col;                      // Move local cursor only
+        _cursorRow = min(row, (uint8_t)(_rows - 1));
+        return;
+    }
+    queueSpecial(cursorCommand(col, row));     // Queue position command
+}
+
+// Build set-cursor command byte for a display position
+uint8_t SerLCD0Base::cursorCommand(uint8_t col, uint8_t row) const {
+    return 0x80 | (col + row_offsets[row]);    // Calculate position command
+}
+
+// Queue a single character write, escaping command prefixes
+bool SerLCD0Base::queueChar(uint8_t c) {
+    uint8_t frame[2] = { c, c };               // Command characters are sent twice
+    return queueBytes(frame, charBytes(c));
+}
+
+// Queue a special (254 prefix) command
+bool SerLCD0Base::queueSpecial(uint8_t c) {
+    uint8_t frame[2] = { SPECIAL_COMMAND, c };
+    return queueBytes(frame, 2);
+}
+
+// Enable shadow framebuffer with given geometry (up to the SerLCD0T Cols x Rows)
+void SerLCD0Base::enableShadowBuffer(uint8_t cols, uint8_t rows) {
+    if(!rewritesQueue()) {
+        return;                                // update() must not queue in LOCK_FREE_SPSC mode
+    }
+    _cols = (cols > 0 && cols < _maxCols) ? cols : _maxCols;
+    _rows = (rows > 0 && rows < _maxRows) ? rows : _maxRows;
+    memset(_frame, ' ', _maxCols * _maxRows);  // Start with blank wanted content
+    _cursorCol = 0;
+    _cursorRow = 0;
+    clearPanel();                              // Bring panel to a known blank state
+    _shadowEnabled = true;
+}
+
+// Queue a real clear and record that the panel will be blank
+void SerLCD0Base::clearPanel() {
+    discardPendingText();
+    queueSpecial(CLEAR_COMMAND);
+    memset(_panel, ' ', _maxCols * _maxRows);
+    _panelCol = 0;                             // Clear homes the panel cursor
+    _panelRow = 0;
+    _dirtyFields = (1 << _fieldCount) - 1;     // Fields not blank are sent again
+    _shadowDirty = true;                       // Shadow cells not blank are sent again
+}
+
+// Queue shadow buffer changes, or dirty fields when writing directly
+void SerLCD0Base::flushLocalChanges() {
+    if(!rewritesQueue()) {
+        return;                                // update() may not queue in this mode
+    }
+    if(_shadowEnabled) {
+        flushShadow();
+    } else if(_dirtyFields) {
+        flushFields();
+    }
+}
+
+// Define a field slot of width cells, returns its id or NO_FIELD
+uint8_t SerLCD0Base::addField(uint8_t col, uint8_t row, uint8_t width) {
+    if(!rewritesQueue() || _fieldCount >= MAX_FIELDS || width == 0 ||
+       row >= _rows || col + width > _cols) {
+        return NO_FIELD;                       // update() may not queue, table full or off screen
+    }
+    Field& field = _fields[_fieldCount];
+    field.col = col;
+    field.row = row;
+    field.width = width;
+    memset(&_frame[row * _cols + col], ' ', width);
+    _staleFields |= 1 << _fieldCount;          // Panel content under a new field is unknown
+    _shadowDirty = true;
+    _dirtyFields |= 1 << _fieldCount;
+    return _fieldCount++;
+}
+
+// Set a field's value, left aligned and padded or cut to its width.
+// Replaces any value update() has not sent yet, so nothing queues up behind it
+bool SerLCD0Base::setField(uint8_t id, const char* text) {
+    if(id >= _fieldCount) {
+        return false;
+    }
+    const Field& field = _fields[id];
+    if(field.row >= _rows || field.col + field.width > _cols) {
+        return false;                          // Shadow buffer geometry changed since addField()
+    }
     
-    // Create and queue cursor position command
-    LCDCommand cmd;
-    cmd.type = LCDCommand::SPECIAL_CMD;        // Set type to special command
-    cmd.data[0] = 0x80 | (col + row_offsets[row]); // Calculate position command
-    cmd.dataLen = 1;                           // Set data length
-    queueCommand(cmd);                         // Queue the command
+    char* cells = &_frame[field.row * _cols + field.col];
+    uint8_t i = 0;
+    for(; i < field.width && text[i] != '\0'; i++) {
+        cells[i] = text[i];
+    }
+    memset(cells + i, ' ', field.width - i);   // Pad to blank out a longer old value
+    _dirtyFields |= 1 << id;                   // Shadow buffer sends it by itself
+    _shadowDirty = true;
+    return true;
 }
 
-// Set RGB backlight color
-void SerLCD0::setBacklight(uint8_t r, uint8_t g, uint8_t b) {
-    // Debug output if enabled
-    if (_SerLCD0_Debug) {
-        Serial.print("Queueing backlight RGB(");
-        Serial.print(r); Serial.print(",");
-        Serial.print(g); Serial.print(",");
-        Serial.print(b); Serial.println(")");
+// Queue the changed cells of each dirty field, first to last difference after one cursor move
+void SerLCD0Base::flushFields() {
+    for(uint8_t id = 0; id < _fieldCount; id++) {
+        uint8_t bit = 1 << id;
+        if(!(_dirtyFields & bit)) {
+            continue;
+        }
+        const Field& field = _fields[id];
+        if(field.row >= _rows || field.col + field.width > _cols) {
+            _dirtyFields &= ~bit;              // No longer on screen
+            continue;
+        }
+        uint8_t cell = field.row * _cols + field.col;
+        
+        // Narrow to the cells that differ from what the panel shows
+        uint8_t first = 0;
+        uint8_t last = field.width;
+        if(!(_staleFields & bit)) {
+            while(first < last && _frame[cell + first] == _panel[cell + first]) first++;
+            while(last > first && _frame[cell + last - 1] == _panel[cell + last - 1]) last--;
+        }
+        if(first < last) {
+            uint16_t needed = CURSOR_CMD_BYTES + textBytes((const uint8_t*)&_frame[cell + first], last - first);
+            if(getQueueFree() < needed) {
+                return;                        // Rest is sent on a later update()
+            }
+            queueSpecial(cursorCommand(field.col + first, field.row));
+            storeText((const uint8_t*)&_frame[cell + first], last - first);
+            memcpy(&_panel[cell + first], &_frame[cell + first], last - first);
+        }
+        _dirtyFields &= ~bit;
+        _staleFields &= ~bit;
     }
+}
+
+// Queue changed cells, choosing the cheapest way to reach each one
+void SerLCD0Base::flushShadow() {
+    for(uint8_t row = 0; row < _rows; row++) {
+        bool inRun = false;                    // Previous cell was just queued
+        for(uint8_t col = 0; col < _cols; col++) {
+            uint8_t cell = row * _cols + col;
+            if(_frame[cell] == _panel[cell]) {
+                inRun = false;                 // Cell unchanged
+                continue;
+            }
+            
+            // Rewriting the unchanged cells in between beats a cursor command if no longer
+            uint8_t cost = rewriteCost(col, row);
+            bool rewrite = (cost <= CURSOR_CMD_BYTES);
+            uint8_t needed = (rewrite ? cost : CURSOR_CMD_BYTES) + charBytes(_frame[cell]);
+            if(getQueueFree() < needed) {
+                return;                        // Rest is sent on a later update()
+            }
+            
+            if(rewrite) {
+                for(uint8_t c = _panelCol; c < col; c++) {
+                    queueChar(_frame[row * _cols + c]);  // Unchanged, panel shows it already
+                }
+                if(!inRun) {
+                    _bytesSaved += CURSOR_CMD_BYTES - cost;
+                }
+            } else {
+                queueSpecial(cursorCommand(col, row));
+            }
+            
+            queueChar(_frame[cell]);
+            _panel[cell] = _frame[cell];       // Panel will show this once sent
+            _panelCol = col + 1;               // Panel cursor advances past it
+            _panelRow = row;
+            inRun = true;
+        }
+    }
+    _shadowDirty = false;                      // Every changed cell is queued
+}
+
+// Bytes needed to move the panel cursor to a cell by rewriting cells, 0xFF if not possible
+uint8_t SerLCD0Base::rewriteCost(uint8_t col, uint8_t row) const {
+    if(row != _panelRow || col < _panelCol || _panelCol >= _cols) {
+        return 0xFF;                           // Only forward moves within a row
+    }
+    
+    uint8_t cost = 0;
+    for(uint8_t c = _panelCol; c < col; c++) {
+        cost += charBytes(_frame[row * _cols + c]);
+        if(cost > CURSOR_CMD_BYTES) {
+            return 0xFF;                       // Already dearer than a cursor command
+        }
+    }
+    return cost;
+}
+
+// Set RGB backlight color
+void SerLCD0Base::setBacklight(uint8_t r, uint8_t g, uint8_t b, Priority priority) {
+    // Encode and queue RGB command
+    uint8_t frame[MAX_CMD_BYTES] = {
+        SETTING_COMMAND,                       // Settings mode prefix
+        RGB_COMMAND,                           // RGB control command
+        r, g, b                                // Red, green, blue values (0-255)
+    };
     
-    // Create and queue RGB command
-    LCDCommand cmd;
-    cmd.type = LCDCommand::RGB_CMD;            // Set type to RGB command
-    cmd.data[0] = r;                           // Set red value
-    cmd.data[1] = g;                           // Set green value
-    cmd.data[2] = b;                           // Set blue value
-    cmd.dataLen = 3;                           // Set data length
+    // Queue command and log the result
+    bool success = (priority == Priority::URGENT) ? queueUrgent(frame, MAX_CMD_BYTES)
+                                                  : queueBytes(frame, MAX_CMD_BYTES);
+    if (producerLogging(SerLCD0Log::BACKLIGHT)) {
+        logEvent(success ? SerLCD0Log::BACKLIGHT_QUEUED : SerLCD0Log::BACKLIGHT_REFUSED, r, g, b);
+    }
+}
+
+// Turn off backlight
+void SerLCD0Base::noBacklight(Priority priority) {
+    setBacklight(0, 0, 0, priority);           // Black is backlight off
+}
+
+// Queue display on command
+void SerLCD0Base::display(Priority priority) {
+    queueDisplayControl(DISPLAY_CONTROL | DISPLAY_ON, priority);
+}
+
+// Queue display off command, content is kept
+void SerLCD0Base::noDisplay(Priority priority) {
+    queueDisplayControl(DISPLAY_CONTROL, priority);
+}
+
+// Queue display control command in the requested lane
+void SerLCD0Base::queueDisplayControl(uint8_t c, Priority priority) {
+    if(priority == Priority::URGENT) {
+        uint8_t frame[2] = { SPECIAL_COMMAND, c };
+        queueUrgent(frame, 2);
+    } else {
+        queueSpecial(c);
+    }
+}
+
+// Time until update() may send the next batch, 0 if it may now
+unsigned long SerLCD0Base::getSettleRemaining() const {
+    unsigned long wait;
+    switch(_state) {
+        case State::PROCESSING: wait = _settleMicros; break;
+        case State::ERROR: wait = _errorResetTime; break;
+        default: return 0;
+    }
+    unsigned long elapsed = micros() - _lastActionMicros;
+    return (elapsed >= wait) ? 0 : wait - elapsed;
+}
+
+// Upper bound of a latency histogram bucket in microseconds, the last has none
+unsigned long SerLCD0Base::getLatencyLimit(uint8_t bucket) {
+    return bucket < LATENCY_BUCKETS - 1 ? 128UL << bucket : 0xFFFFFFFFUL;
+}
+
+// Commands of a type whose wait fell in a bucket
+uint32_t SerLCD0Base::getLatencyCount(LCDCommand::Type type, uint8_t bucket) const {
+    if(!timing() || type == LCDCommand::NONE || bucket >= LATENCY_BUCKETS) {
+        return 0;
+    }
+    return latencyCounts(type)[bucket];
+}
+
+// Upper bound of the bucket that brings the count to percent of a type's commands,
+// e.g. percent 99 gives a wait 99% of commands stayed under. 0 when none were sent
+unsigned long SerLCD0Base::getLatencyPercentile(LCDCommand::Type type, uint8_t percent) const {
+    uint32_t total = 0;
+    for(uint8_t bucket = 0; bucket < LATENCY_BUCKETS; bucket++) {
+        total += getLatencyCount(type, bucket);
+    }
+    if(total == 0) {
+        return 0;
+    }
     
-    // Queue command and debug output result
-    bool success = queueCommand(cmd);
-    if (_SerLCD0_Debug) {
-        Serial.print("Backlight command ");
-        Serial.println(success ? "queued" : "failed to queue");
+    uint32_t seen = 0;
+    for(uint8_t bucket = 0; bucket < LATENCY_BUCKETS; bucket++) {
+        seen += getLatencyCount(type, bucket);
+        if((uint64_t)seen * 100 >= (uint64_t)total * percent) {
+            return getLatencyLimit(bucket);
+        }
+    }
+    return getLatencyLimit(LATENCY_BUCKETS - 1);
+}
+
+// Clear the histograms, e.g. after reading them out
+void SerLCD0Base::resetLatencyStats() {
+    if(timing()) {
+        memset(latencyCounts(LCDCommand::WRITE_CHAR), 0, 4 * LATENCY_BUCKETS * sizeof(uint32_t));
     }
 }
 
 // Convert state enum to readable string
-const char* SerLCD0::getStateString() const {
+const char* SerLCD0Base::getStateString() const {
     switch(_state) {
         case State::READY: return "READY";              // Ready for commands
         case State::PROCESSING: return "PROCESSING";    // Processing command
@@ -292,3 +1222,173 @@ const char* SerLCD0::getStateString() const {
         default: return "UNKNOWN";                      // Invalid state
     }
 }
+
+// Add a display to the group, call begin() on it as usual
+bool SerLCD0Group::add(SerLCD0Base& lcd) {
+    if(_count >= MAX_DISPLAYS) {
+        return false;
+    }
+    _displays[_count++] = &lcd;
+    return true;
+}
+
+// One pass over the displays, starting after the last one that sent.
+// Returns true when every display is ready
+bool SerLCD0Group::update() {
+    if(busWait()) {
+        return false;                          // Batch still on the bus
+    }
+    
+    for(uint8_t n = 0; n < _count; n++) {
+        uint8_t index = (_next + n) % _count;
+        if(service(index)) {
+            _next = (index + 1) % _count;      // Rotate so every display gets a turn first
+            if(_displays[index]->isTransferring()) {
+                return false;                  // Bus taken until the transfer finishes
+            }
+        }
+    }
+    return allReady();
+}
+
+// Send to whichever display is ready for up to budgetMicros, waiting for the first
+// settle time to end when none is and it ends within the budget
+bool SerLCD0Group::update(unsigned long budgetMicros) {
+    unsigned long start = micros();            // Start of this time slice
+    
+    while(micros() - start < budgetMicros) {
+        if(busWait()) {
+            break;                             // Bus works on without us
+        }
+        if(sendNext()) {
+            continue;
+        }
+        
+        // Nobody had anything to send or could send, wait for the next display to settle
+        unsigned long wait = nextSettle();
+        if(wait == 0 || wait > budgetMicros - (micros() - start)) {
+            break;                             // All idle, or next settle ends after this slice
+        }
+        yield();
+    }
+    return allReady();
+}
+
+// Offer the bus to each display in turn from the one after the last sender
+bool SerLCD0Group::sendNext() {
+    for(uint8_t n = 0; n < _count; n++) {
+        uint8_t index = (_next + n) % _count;
+        if(service(index)) {
+            _next = (index + 1) % _count;      // Rotate so every display gets a turn first
+            return true;
+        }
+    }
+    return false;
+}
+
+// Run one display's state machine, true if it put a batch on the bus
+bool SerLCD0Group::service(uint8_t index) {
+    SerLCD0Base& lcd = *_displays[index];
+    if(!lcd.isReady()) {
+        lcd.update();                          // Ends a finished settle or error wait
+        if(!lcd.isReady()) {
+            return false;
+        }
+    }
+    lcd.update();                              // Sends if it has anything queued
+    return !lcd.isReady() && !lcd.hasError();
+}
+
+// Poll the member with a batch on the bus, true while it is still there
+bool SerLCD0Group::busWait() {
+    for(uint8_t i = 0; i < _count; i++) {
+        if(_displays[i]->isTransferring()) {
+            _displays[i]->update();
+            return _displays[i]->isTransferring();
+        }
+    }
+    return false;
+}
+
+// Shortest settle or error wait still running among displays with something to send,
+// 0 if none is
+unsigned long SerLCD0Group::nextSettle() const {
+    unsigned long wait = 0;
+    for(uint8_t i = 0; i < _count; i++) {
+        if(!_displays[i]->hasWork()) {
+            continue;                          // Waiting for it would send nothing
+        }
+        unsigned long remaining = _displays[i]->getSettleRemaining();
+        if(remaining > 0 && (wait == 0 || remaining < wait)) {
+            wait = remaining;
+        }
+    }
+    return wait;
+}
+
+// Check that no display is settling, recovering or transferring
+bool SerLCD0Group::allReady() const {
+    for(uint8_t i = 0; i < _count; i++) {
+        if(!_displays[i]->isReady()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Add the group of displays on one bus
+bool SerLCD0MultiBus::add(SerLCD0Group& group) {
+    if(_count >= MAX_BUSES) {
+        return false;
+    }
+    _groups[_count++] = &group;
+    return true;
+}
+
+// One turn for every bus. Returns true when every display is ready
+bool SerLCD0MultiBus::update() {
+    bool ready = true;
+    for(uint8_t i = 0; i < _count; i++) {
+        ready = _groups[i]->update() && ready;
+    }
+    return ready;
+}
+
+// Start a batch on every bus that is free and has a display ready, for up to
+// budgetMicros. Waits for a settle time to end only on buses without a transfer in
+// flight, and hands the slice back once nothing more can start within it
+bool SerLCD0MultiBus::update(unsigned long budgetMicros) {
+    unsigned long start = micros();            // Start of this time slice
+    
+    while(micros() - start < budgetMicros) {
+        bool sent = false;
+        unsigned long wait = 0;                // Next settle end on a free bus
+        for(uint8_t i = 0; i < _count; i++) {
+            SerLCD0Group& group = *_groups[i];
+            if(group.busWait()) {
+                continue;                      // This bus works on without us
+            }
+            if(group.sendNext()) {
+                sent = true;
+                continue;
+            }
+            unsigned long remaining = group.nextSettle();
+            if(remaining > 0 && (wait == 0 || remaining < wait)) {
+                wait = remaining;
+            }
+        }
+        if(sent) {
+            continue;
+        }
+        if(wait == 0 || wait > budgetMicros - (micros() - start)) {
+            break;                             // Idle, in flight, or next settle ends after this slice
+        }
+        yield();
+    }
+    
+    bool ready = true;
+    for(uint8_t i = 0; i < _count; i++) {
+        ready = _groups[i]->allReady() && ready;
+    }
+    return ready;
+}
@@ -1,6 +1,6 @@
 // SerLCD0.h - Non-blocking LCD library for OpenLCD displays
 // Version F0.0.3
-// Designed for Arduino R4 Wire/Wire1/Wire2 compatibility
+// Designed for Arduino R4 Wire/Wire1/Wire2 compatibility, with serial and SPI transports
 // Uses non-blocking operations, command queue, and state machine for timing
 
 #ifndef SERLCD0_H
@@ -8,8 +8,60 @@
 
 #include <Arduino.h>
 #include <Wire.h>
+#include <SPI.h>
 
-// Command structure for LCD operations queue
+// Debug log categories compiled in, e.g. build with -DSERLCD0_LOG_MASK=0x0F for all.
+// The default of none leaves no debug branches or strings in the library.
+// Set it for the whole build (compiler flags), not with a #define in the sketch:
+// SerLCD0.cpp decides what is logged, the sketch's value only sizes the ring in
+// SerLCD0T, so a sketch-only #define logs nothing (the class layout does not change)
+#ifndef SERLCD0_LOG_MASK
+#define SERLCD0_LOG_MASK 0
+#endif
+
+// Enqueue-to-transmit latency histograms, build with -DSERLCD0_LATENCY_STATS=1 to keep them.
+// Costs four bytes per queue byte plus about 600 bytes per display, all in SerLCD0T.
+// Set it for the whole build like SERLCD0_LOG_MASK, a sketch-only #define records nothing
+#ifndef SERLCD0_LATENCY_STATS
+#define SERLCD0_LATENCY_STATS 0
+#endif
+
+// Debug log categories, setSerLCD0_Debug() switches the compiled-in ones at run time
+struct SerLCD0Log {
+    static constexpr uint8_t QUEUE = 0x01;       // Queue full, text truncated
+    static constexpr uint8_t BACKLIGHT = 0x02;   // Backlight colours queued and sent
+    static constexpr uint8_t BUS = 0x04;         // Failed and timed out transfers
+    static constexpr uint8_t RECOVERY = 0x08;    // Error counts and resets
+    static constexpr uint8_t ALL = 0x0F;
+    static constexpr uint8_t MASK = SERLCD0_LOG_MASK;  // Categories compiled in
+    
+    // Event ids and their arguments, extras/host/SerLCD0_LogDecode.cpp turns them into text
+    enum Event : uint8_t {
+        QUEUE_FULL = 1,          // Frame refused: a = frame bytes
+        TEXT_TRUNCATED,          // Run cut short: a = characters dropped (255 = more)
+        BACKLIGHT_QUEUED,        // a, b, c = red, green, blue
+        BACKLIGHT_REFUSED,       // a, b, c = red, green, blue
+        BACKLIGHT_SENT,          // Taken into a batch: a, b, c = red, green, blue
+        TRANSFER_TIMEOUT,        // a = batch bytes
+        TRANSFER_FAILED,         // a = batch bytes
+        ERROR_COUNTED,           // a = error count, b = state (0 ready, 1 processing,
+                                 // 2 awaiting response, 3 error)
+        ERROR_STATE,             // Queue dropped, reset follows: a = error count
+        EVENTS_LOST              // Log ring was full: a = events lost (255 = more)
+    };
+    
+    // One logged event, written into the ring in a few instructions
+    struct Record {
+        uint32_t micros;         // micros() when logged
+        uint8_t id;              // Event
+        uint8_t a, b, c;         // Arguments
+    };
+    
+    // Drained to Serial as "~" + 8 hex digits of micros, 2 of id and 6 of arguments
+    static constexpr uint8_t LINE_BYTES = 19;    // Including "\r\n"
+};
+
+// Command types carried in the queue's encoded OpenLCD byte stream
 struct LCDCommand {
     // Command types for different LCD operations
     enum Type {
@@ -19,45 +71,106 @@ struct LCDCommand {
         SETTING_CMD,    // Settings commands (0x7C prefix)
         RGB_CMD         // RGB backlight control command
     };
-    
-    Type type;                 // Type of command to execute
-    uint8_t data[3];          // Command data (up to 3 bytes for RGB)
-    uint8_t dataLen;          // Number of valid data bytes
 };
 
 // Main LCD control class, inherits from Print for text output
-class SerLCD0 : public Print {
+// Queue and shadow buffer storage is supplied by SerLCD0T below
+class SerLCD0Base : public Print {
 public:
-    // Constructor - allows selection of Wire interface and I2C address
-    SerLCD0(TwoWire &wirePort = Wire, uint8_t i2c_addr = 0x72);
+    // What happens to new commands when the queue is full
+    enum class OverflowPolicy : uint8_t {
+        DROP_NEWEST,        // Refuse the new command (default)
+        DROP_OLDEST         // Discard the oldest unsent commands to make room
+    };
+    
+    // Lane a backlight or display on/off command is queued in
+    enum class Priority : uint8_t {
+        NORMAL,             // In order with text and cursor moves (default)
+        URGENT              // Sent before anything in the normal queue
+    };
+    
+    // Which contexts may queue commands and call update()
+    enum class QueueMode : uint8_t {
+        SINGLE_CONTEXT,     // Everything from loop() (default)
+        LOCK_FREE_SPSC,     // One producer (e.g. a timer ISR) and one update() caller
+        LOCKED_MPSC         // Producers take the SerLCD0T LockPolicy, one update() caller
+    };
+    
+    // Progress of a batch handed to the transport
+    enum class TransferStatus : uint8_t {
+        BUSY,               // Still on the bus
+        DONE,               // Sent (and acknowledged, where the bus has one)
+        FAILED              // Not delivered
+    };
     
     // Core initialization and control
-    void begin(TwoWire &wirePort);          // Initialize with Wire interface
+    virtual void begin();                   // Initialize over the constructed transport
     void reinitialize();                    // Reset display to initial state
     bool update();                          // Process command queue (call in loop)
+    bool update(unsigned long budgetMicros);  // Drain queue for up to budgetMicros
     
     // Basic display operations
     void clear();                           // Clear display content
     void home();                            // Return cursor to home position
     void setCursor(uint8_t col, uint8_t row);  // Set cursor position
-    void setBacklight(uint8_t r, uint8_t g, uint8_t b);  // Set RGB backlight
-    void noBacklight();                     // Turn off backlight
-    void display();                         // Turn on display
-    void noDisplay();                       // Turn off display
+    void setBacklight(uint8_t r, uint8_t g, uint8_t b,
+                      Priority priority = Priority::NORMAL);  // Set RGB backlight
+    void noBacklight(Priority priority = Priority::NORMAL);   // Turn off backlight
+    void display(Priority priority = Priority::NORMAL);       // Turn on display
+    void noDisplay(Priority priority = Priority::NORMAL);     // Turn off display
+    
+    // Timing configuration methods, milliseconds except the Micros setters
+    void setInitTime(unsigned long ms) { _initTime = ms * 1000; }  // Set initialization delay
+    void setCmdTime(unsigned long ms) { _cmdTime = ms * 1000; }    // Set cursor/home/display command time
+    void setClearTime(unsigned long ms) { _clearTime = ms * 1000; }  // Set clear screen time
+    void setErrorResetTime(unsigned long ms) { _errorResetTime = ms * 1000; }  // Set error recovery time
+    void setCharTime(unsigned long ms) { _charTime = ms * 1000; }  // Set character time
+    void setSettingTime(unsigned long ms) { _settingTime = ms * 1000; }  // Set settings command time
+    void setRGBTime(unsigned long ms) { _rgbTime = ms * 1000; }    // Set backlight change time
+    void setTransferTimeout(unsigned long ms) { _transferTimeout = ms * 1000; }  // Set longest time a batch may be in flight
+    void setInitTimeMicros(unsigned long us) { _initTime = us; }   // Initialization delay in microseconds
+    void setCmdTimeMicros(unsigned long us) { _cmdTime = us; }     // Command time in microseconds
+    void setClearTimeMicros(unsigned long us) { _clearTime = us; }  // Clear time in microseconds
+    void setErrorResetTimeMicros(unsigned long us) { _errorResetTime = us; }  // Error recovery time in microseconds
+    void setCharTimeMicros(unsigned long us) { _charTime = us; }   // Character time in microseconds
+    void setSettingTimeMicros(unsigned long us) { _settingTime = us; }  // Settings time in microseconds
+    void setRGBTimeMicros(unsigned long us) { _rgbTime = us; }     // Backlight time in microseconds
+    void setTransferTimeoutMicros(unsigned long us) { _transferTimeout = us; }  // Transfer timeout in microseconds
+    
+    // Shadow framebuffer - write()/setCursor() update a local copy, update() sends changed cells
+    void enableShadowBuffer(uint8_t cols = 0, uint8_t rows = 0);  // Enable dirty-cell diffing (0 = full size)
+    void disableShadowBuffer() { _shadowEnabled = false; }        // Return to direct queueing
+    bool hasShadowBuffer() const { return _shadowEnabled; }       // Check if shadow buffer active
+    uint32_t getBytesSaved() const { return _bytesSaved; }        // Bytes saved by cursor planning
+    
+    // Backpressure - a full queue never counts as a bus error
+    void setOverflowPolicy(OverflowPolicy policy) { _overflowPolicy = policy; }  // Choose what a full queue drops
+    OverflowPolicy getOverflowPolicy() const { return _overflowPolicy; }      // Get overflow policy
+    uint32_t getOverflowCount() const { return _overflowCount; }  // Characters and commands dropped or refused
+    bool reserve(uint16_t bytes);                                 // Make sure bytes can be queued
     
-    // Timing configuration methods
-    void setInitTime(unsigned long ms) { _initTime = ms; }         // Set initialization delay
-    void setCmdTime(unsigned long ms) { _cmdTime = ms; }           // Set command processing time
-    void setClearTime(unsigned long ms) { _clearTime = ms; }       // Set clear screen time
-    void setErrorResetTime(unsigned long ms) { _errorResetTime = ms; }  // Set error recovery time
+    // Concurrency - LOCK_FREE_SPSC turns off features that rewrite unsent commands
+    void setQueueMode(QueueMode mode);                            // Set before producers start
+    QueueMode getQueueMode() const { return _queueMode; }         // Get queue mode
+    size_t tryPrint(const char* str);                             // Print all of str or nothing
+    bool writeField(uint8_t col, uint8_t row, const char* text);  // Cursor move and text as one unit
+    
+    // Field slots - latest value wins, update() sends changed cells once the queue drains
+    static const uint8_t MAX_FIELDS = 8;                          // Field slots available
+    static const uint8_t NO_FIELD = 0xFF;                         // addField() failed
+    uint8_t addField(uint8_t col, uint8_t row, uint8_t width);    // Define field, returns id
+    bool setField(uint8_t id, const char* text);                  // Replace field value
+    void clearFields() { _fieldCount = 0; _dirtyFields = 0; _staleFields = 0; }  // Remove all fields
     
     // Debug control - unique names to avoid conflicts
     static void setSerLCD0_Debug(bool enable) { _SerLCD0_Debug = enable; }
     static void setSerLCD0_ErrorThreshold(uint8_t threshold) { _SerLCD0_ErrorThreshold = threshold; }
     
     // Queue and status monitoring
-    uint8_t getQueueSize() const { return QUEUE_SIZE; }           // Get maximum queue capacity
-    uint8_t getQueueCount() const;                                // Get current items in queue
+    uint16_t getQueueSize() const { return _queueMask + 1; }      // Get queue capacity in bytes
+    uint16_t getQueueCount() const;                               // Get encoded bytes in queue
+    uint8_t getUrgentCount() const { return (_urgentTail - _urgentHead) & URGENT_MASK; }  // Get urgent lane bytes
+    uint16_t getQueueFree() const { return _queueMask - getQueueCount(); }  // Get bytes that can be queued
     float getQueuePercentFull() const;                           // Get queue fill percentage
     uint8_t getErrorCount() const { return _errorCount; }         // Get cumulative error count
     
@@ -65,35 +178,101 @@ public:
     bool isReady() const { return _state == State::READY; }       // Check if ready for command
     bool isBusy() const { return _state != State::READY; }        // Check if processing
     bool hasError() const { return _state == State::ERROR; }      // Check for error state
+    bool hasWork() const {                                        // Anything queued, staged, on the bus or to flush
+        return hasPending() || (_shadowEnabled ? _shadowDirty : _dirtyFields != 0);
+    }
+    bool isTransferring() const { return _state == State::AWAITING_RESPONSE; }  // Check for batch on the bus
+    unsigned long getSettleRemaining() const;                     // Microseconds until next batch may go
     bool needsRefresh() const { return _needsFullRefresh; }       // Check if refresh needed
     void clearRefreshFlag() { _needsFullRefresh = false; }        // Clear refresh flag
     const char* getStateString() const;                           // Get state as string
     static bool getDebug() { return _SerLCD0_Debug; }             // Get debug status
     
+    // Time commands waited between queueing and being handed to the transport, per type.
+    // Bucket n counts waits below 128 << n microseconds, the last one everything longer.
+    // All zero unless built with SERLCD0_LATENCY_STATS
+    static const uint8_t LATENCY_BUCKETS = 16;                    // Buckets per command type
+    static unsigned long getLatencyLimit(uint8_t bucket);         // Bucket's upper bound (us)
+    uint32_t getLatencyCount(LCDCommand::Type type, uint8_t bucket) const;  // Commands in bucket
+    unsigned long getLatencyPercentile(LCDCommand::Type type, uint8_t percent) const;  // Bound for percent of commands (us)
+    void resetLatencyStats();                                     // Start new measurement period
+    
     // Print interface implementation for text output
     virtual size_t write(uint8_t);                                // Write single character
+    virtual size_t write(const uint8_t* buffer, size_t size);     // Write run of characters
+    virtual int availableForWrite();                              // Queue bytes free for writing
     using Print::write;                                           // Use Print's write methods
 
+protected:
+    // Constructor - storage must hold queueSize bytes and cols x rows cells twice,
+    // stamps queueSize + LATENCY_WORDS entries and log LOG_SIZE records (either may be nullptr)
+    SerLCD0Base(uint8_t* queue, uint32_t* stamps, uint16_t queueSize,
+                char* frame, char* panel, uint8_t cols, uint8_t rows, SerLCD0Log::Record* log);
+    static const uint8_t LOG_SIZE = 16;     // Debug events held (power of two)
+    static const uint8_t LATENCY_WORDS = 144;  // Urgent lane and batch stamps plus histograms
+    
+    // Start one batch over the SerLCD0T Transport policy, false if it could not start.
+    // data stays untouched until pollSend() stops returning BUSY
+    virtual bool startSend(const uint8_t* data, uint8_t len) = 0;
+    virtual TransferStatus pollSend() = 0;  // Progress of the batch last started
+    
+    // Producer critical section for LOCKED_MPSC, supplied by the SerLCD0T LockPolicy
+    virtual void lockProducers() {}
+    virtual void unlockProducers() {}
+
 private:
     // Display state management
     enum class State {
         READY,              // Ready for next command
         PROCESSING,         // Processing current command
-        AWAITING_RESPONSE, // Waiting for display response
+        AWAITING_RESPONSE, // Batch handed to transport, waiting for it to finish
         ERROR              // Error recovery state
     };
     
-    // Command queue configuration
-    static const uint8_t QUEUE_SIZE = 32;    // Maximum queued commands
-    LCDCommand _cmdQueue[QUEUE_SIZE];        // Command queue storage
-    uint8_t _queueHead;                      // Queue read position
-    uint8_t _queueTail;                      // Queue write position
+    // Command queue of encoded OpenLCD frames (size is a power of two)
+    // Frames are self-delimiting: a plain character, 254 or 0x7C plus one byte,
+    // or 0x7C 0x2B plus red, green and blue
+    uint8_t* _queue;                         // Encoded byte ring storage
+    uint16_t _queueMask;                     // Queue size - 1, wraps positions
+    // Head is written only by update() and tail only by the producer, each after a
+    // memory barrier, so in LOCK_FREE_SPSC mode neither side needs a lock
+    volatile uint16_t _queueHead;            // Queue read position
+    volatile uint16_t _queueTail;            // Queue write position
+    uint16_t _lastFrame;                     // Start of most recently queued frame
+    // Urgent lane, a small ring of backlight and display on/off frames sent first
+    static const uint8_t URGENT_QUEUE_SIZE = 16;  // Three backlight commands
+    static const uint8_t URGENT_MASK = URGENT_QUEUE_SIZE - 1;
+    uint8_t _urgent[URGENT_QUEUE_SIZE];      // Urgent frame storage
+    volatile uint8_t _urgentHead;            // Urgent read position
+    volatile uint8_t _urgentTail;            // Urgent write position
+    
+    // Enqueue times (micros) at each frame's first byte, alongside the lanes and batches,
+    // then the histograms. Storage from SerLCD0T, nullptr when SERLCD0_LATENCY_STATS is off
+    static constexpr bool LATENCY_STATS = SERLCD0_LATENCY_STATS != 0;
+    uint32_t* _stamps;                       // Per _queue byte, then per _urgent and batch byte
     
-    // Timing parameters (milliseconds)
-    unsigned long _initTime = 1000;          // Display initialization time
-    unsigned long _cmdTime = 5;              // Command processing time
-    unsigned long _clearTime = 50;           // Clear screen time
-    unsigned long _errorResetTime = 100;     // Error recovery time
+    OverflowPolicy _overflowPolicy;          // What a full queue drops
+    uint32_t _overflowCount;                 // Frames dropped by the overflow policy
+    QueueMode _queueMode;                    // Producer/consumer arrangement
+    bool _initPending;                       // Send clear and backlight before the queue
+    bool _lockProducers;                     // Producers serialize through the LockPolicy
+    
+    // Timing parameters (microseconds), compared against micros() by unsigned
+    // subtraction so the 71 minute wrap-around does not matter
+    unsigned long _initTime = 1000000;       // Display initialization time
+    unsigned long _cmdTime = 5000;           // Cursor, home and display command time
+    unsigned long _clearTime = 50000;        // Clear screen time
+    unsigned long _errorResetTime = 100000;  // Error recovery time
+    unsigned long _settingTime = 10000;      // Settings command time
+    unsigned long _rgbTime = 10000;          // Backlight change time
+    unsigned long _transferTimeout = 25000;  // Longest time a batch may stay in flight
+    unsigned long _charTime = 250;           // Character time
+    unsigned long _settleMicros = 0;         // Settle time for last transaction
+    
+    // Batch transmission limits
+    static const uint8_t WIRE_BUFFER_SIZE = 32;  // Wire TX buffer capacity (R4)
+    static const uint8_t MAX_CMD_BYTES = 5;      // Largest encoded command (RGB)
+    static const uint8_t CURSOR_CMD_BYTES = 2;   // Set-cursor command size on the wire
     
     // OpenLCD firmware command constants
     static const uint8_t SPECIAL_COMMAND = 254;  // Special command prefix
@@ -101,28 +280,364 @@ private:
     static const uint8_t CLEAR_COMMAND = 0x01;   // Clear display command
     static const uint8_t HOME_COMMAND = 0x02;    // Home cursor command
     static const uint8_t RGB_COMMAND = 0x2B;     // RGB backlight command ('+'')
+    static const uint8_t DISPLAY_CONTROL = 0x08; // Display control command
+    static const uint8_t DISPLAY_ON = 0x04;      // Display control: display on
     static const uint8_t COLD_START_TIME = 350;  // Cold start delay
     
     // Debug and error control
     static bool _SerLCD0_Debug;              // Debug output enable
+    static bool logging(uint8_t category) {  // Category compiled in and enabled, folds to false when not compiled in
+        return (SerLCD0Log::MASK & category) != 0 && _SerLCD0_Debug;
+    }
+    bool producerLogging(uint8_t category) const {  // Producer events share the ring only in SINGLE_CONTEXT
+        return logging(category) && _queueMode == QueueMode::SINGLE_CONTEXT;
+    }
     static uint8_t _SerLCD0_ErrorThreshold;  // Error threshold for reset
     
-    // Hardware interface
-    TwoWire* _wirePort;                      // I2C interface pointer
-    uint8_t _i2cAddr;                        // I2C device address
+    // Shadow framebuffer state
+    char* _frame;                            // Content the sketch wants shown
+    char* _panel;                            // Content the panel is known to show
+    uint8_t _maxCols;                        // Shadow buffer columns
+    uint8_t _maxRows;                        // Shadow buffer rows
+    bool _shadowEnabled;                     // Shadow buffer active
+    uint8_t _cols;                           // Active columns
+    uint8_t _rows;                           // Active rows
+    uint8_t _cursorCol;                      // Local cursor column
+    uint8_t _cursorRow;                      // Local cursor row
+    uint8_t _panelCol;                       // Panel cursor column after queued commands
+    uint8_t _panelRow;                       // Panel cursor row after queued commands
+    uint32_t _bytesSaved;                    // Bytes saved versus one cursor command per run
+    bool _shadowDirty;                       // Shadow buffer may differ from the panel
+    
+    // Field slots, values live in _frame and what was sent in _panel
+    struct Field {
+        uint8_t col;                         // First column
+        uint8_t row;                         // Row
+        uint8_t width;                       // Cells
+    };
+    Field _fields[MAX_FIELDS];               // Defined fields
+    uint8_t _fieldCount;                     // Fields defined
+    uint8_t _dirtyFields;                    // Bit per field: value not sent yet
+    uint8_t _staleFields;                    // Bit per field: panel content unknown, send all
     
     // State tracking
     State _state;                            // Current state
-    unsigned long _lastActionTime;           // Last action timestamp
+    unsigned long _lastActionMicros;         // Last action timestamp (microseconds)
     uint8_t _errorCount;                     // Error counter
     bool _needsFullRefresh;                  // Display refresh flag
     
+    // Debug event ring, written where the event happens and drained by update() when
+    // idle so logging does not change the timing it records
+    static const uint8_t LOG_MASK = LOG_SIZE - 1;
+    SerLCD0Log::Record* _log;                // Ring storage from SerLCD0T, nullptr when compiled out
+    uint8_t _logHead;                        // Next event to drain
+    uint8_t _logTail;                        // Next free entry
+    uint8_t _logLost;                        // Events refused since last drain (saturates)
+    
+    // Batch taken off the queue, kept until the transport confirms it, and the
+    // next normal batch, staged while the current one is on the bus
+    uint8_t _batchStorage[2][WIRE_BUFFER_SIZE];  // Storage for both batches
+    uint8_t* _txBuf;                         // Encoded batch being sent
+    uint8_t _txLen;                          // Bytes in _txBuf, 0 when none
+    unsigned long _txSettle;                 // Settle time once _txBuf is out (microseconds)
+    bool _txAbandoned;                       // Timed out, transport may still be reading _txBuf
+    uint8_t* _nextBuf;                       // Normal lane batch staged during a transfer
+    uint8_t _nextLen;                        // Bytes in _nextBuf, 0 when none
+    unsigned long _nextSettle;               // Settle time for _nextBuf (microseconds)
+    
     // Internal command processing
-    bool queueCommand(const LCDCommand& cmd);   // Add command to queue
-    bool processNextCommand();                  // Process next queued command
-    bool sendCommand(const LCDCommand& cmd);    // Send command to display
+    bool queueBytes(const uint8_t* data, uint8_t len);  // Add encoded frame to queue
+    bool storeFrame(const uint8_t* data, uint8_t len);  // Add frame, queue lock held
+    bool queueUrgent(const uint8_t* data, uint8_t len);  // Add frame to urgent lane
+    bool rewriteSameKind(uint8_t* ring, uint16_t mask, uint16_t head, uint16_t tail,
+                         const uint8_t* data, uint8_t len);  // Update superseded frames in a lane
+    void queueDisplayControl(uint8_t c, Priority priority);  // Queue display on/off in a lane
+    size_t storeText(const uint8_t* buffer, size_t size);  // Add characters, queue lock held
+    static size_t textBytes(const uint8_t* text, size_t size);  // Encoded size of characters
+    void lockQueue() { if(_lockProducers) lockProducers(); }    // Enter producer section
+    void unlockQueue() { if(_lockProducers) unlockProducers(); }  // Leave producer section
+    bool makeRoom(uint16_t bytes);              // Free queue space under the overflow policy
+    bool coalesceFrame(const uint8_t* data, uint8_t len);  // Merge into superseded frame
+    bool lastFramePending() const;              // Check if last queued frame is unsent
+    void discardPendingText();                  // Drop frames a clear supersedes
+    bool processNextCommand();                  // Process next queued commands
+    static uint8_t frameLength(const uint8_t* ring, uint16_t mask, uint16_t index);  // Length of frame in a lane
+    uint8_t frameLength(uint16_t index) const {  // Length of frame at queue position
+        return frameLength(_queue, _queueMask, index);
+    }
+    bool hasPending() const {                   // Anything for update() to send
+        return _txLen != 0 || _nextLen != 0 || _queueHead != _queueTail ||
+               _urgentHead != _urgentTail || _initPending;
+    }
+    static LCDCommand::Type frameType(uint8_t first, uint8_t second);  // Classify encoded frame
+    unsigned long settleBudget(uint8_t first, uint8_t second) const;  // Settle time for frame (us)
+    bool endsBatch(uint8_t first, uint8_t second) const;  // Check if frame must end a batch
+    void stageBatch();                          // Take next batch off the queue into _txBuf
+    uint8_t gatherBatch(const uint8_t* ring, uint16_t mask, uint16_t head, uint16_t tail,
+                        uint8_t* buf, unsigned long& settle);  // Copy lane frames into a batch
+    void stageNext();                           // Stage next normal batch during a transfer
+    void stageInit();                           // Put initialization sequence in _txBuf
+    void copyStamps(const uint32_t* stamps, uint16_t mask, uint16_t head,
+                    const uint8_t* buf, uint8_t len);  // Carry lane stamps into a batch
+    bool timing() const {                       // Latency stats compiled in and given storage
+        return LATENCY_STATS && _stamps != nullptr;
+    }
+    uint32_t* urgentStamps() const {            // Stamps belonging to the urgent lane
+        return _stamps ? _stamps + _queueMask + 1 : nullptr;
+    }
+    uint32_t* batchStamps(const uint8_t* buf) const {  // Stamps belonging to a batch buffer
+        return _stamps ? urgentStamps() + URGENT_QUEUE_SIZE +
+                         (buf == _batchStorage[0] ? 0 : WIRE_BUFFER_SIZE) : nullptr;
+    }
+    uint32_t* latencyCounts(LCDCommand::Type type) const {  // Histogram of a command type
+        return _stamps ? urgentStamps() + URGENT_QUEUE_SIZE + 2 * WIRE_BUFFER_SIZE +
+                         (type - 1) * LATENCY_BUCKETS : nullptr;
+    }
+    void recordLatency(unsigned long sent);     // Add _txBuf's commands to the histograms
+    void logEvent(uint8_t id, uint8_t a = 0, uint8_t b = 0, uint8_t c = 0);  // Record event in log ring
+    void drainLog();                            // Write logged events while Serial has room
+    bool transmit();                            // Start sending _txBuf
+    bool checkTransfer();                       // Poll batch in flight
+    bool rewritesQueue() const {                // Producer may change unsent frames
+        return _queueMode == QueueMode::SINGLE_CONTEXT;
+    }
+    static uint8_t charBytes(uint8_t c) {       // Encoded size of a character
+        return (c == SPECIAL_COMMAND || c == SETTING_COMMAND) ? 2 : 1;
+    }
+    static bool isPositionCommand(uint8_t c) {  // Set-cursor or home special command
+        return (c & 0x80) || c == HOME_COMMAND;
+    }
+    static bool isDisplayCommand(uint8_t c) {   // Display on/off special command
+        return (c & 0xF8) == DISPLAY_CONTROL;
+    }
+    bool queueChar(uint8_t c);                 // Queue character write
+    bool queueSpecial(uint8_t c);              // Queue special (254 prefix) command
+    uint8_t cursorCommand(uint8_t col, uint8_t row) const;  // Build set-cursor command byte
+    void clearPanel();                         // Queue clear and mark panel blank
+    void shadowWrite(uint8_t b);               // Store character at local cursor
+    void flushLocalChanges();                  // Queue shadow buffer or field changes
+    void flushShadow();                        // Queue changed cells from shadow buffer
+    void flushFields();                        // Queue changed cells of dirty fields
+    uint8_t rewriteCost(uint8_t col, uint8_t row) const;  // Bytes to reach cell by rewriting
     void handleError();                        // Handle error condition
     void resetQueue();                         // Clear command queue
 };
 
+// Producer lock for single-context and lock-free use
+struct SerLCD0NoLock {
+    void lock() {}
+    void unlock() {}
+};
+
+// Producer lock for LOCKED_MPSC between loop() and interrupts on single-core boards
+struct SerLCD0InterruptLock {
+    void lock() { noInterrupts(); }
+    void unlock() { interrupts(); }
+};
+
+// Transport policies carry one batch of encoded OpenLCD bytes per start() call.
+// Each has a Port type and DEFAULT_ADDRESS for the SerLCD0T constructor, setPort(),
+// begin(), start() and poll(); defaultPort() is optional. Blocking transports send the
+// whole batch in start() and poll() always reports DONE
+
+// I2C transport (default), one Wire transaction per batch
+class SerLCD0I2CTransport {
+public:
+    typedef TwoWire Port;
+    static const uint8_t DEFAULT_ADDRESS = 0x72;                  // OpenLCD I2C address
+    static Port& defaultPort() { return Wire; }
+    
+    SerLCD0I2CTransport(TwoWire& wire, uint8_t address) : _wire(&wire), _address(address) {}
+    void setPort(TwoWire& wire) { _wire = &wire; }                // Change Wire interface
+    void begin() {}                                               // Sketch calls Wire.begin()
+    bool start(const uint8_t* data, uint8_t len) {
+        _wire->beginTransmission(_address);
+        _wire->write(data, len);
+        return _wire->endTransmission() == 0;                     // Zero is ACKed
+    }
+    SerLCD0Base::TransferStatus poll() { return SerLCD0Base::TransferStatus::DONE; }
+
+private:
+    TwoWire* _wire;                          // I2C interface
+    uint8_t _address;                        // Display address
+};
+
+// Interrupt or DMA driven I2C transport, update() starts each batch and returns, then
+// polls for completion, so loop() is not held for the bus time. AsyncWire is the board's
+// non-blocking I2C driver (Wire only blocks) and needs:
+//   bool startWrite(uint8_t address, const uint8_t* data, uint8_t len)  false if busy
+//   int pollWrite()  negative while in flight, then endTransmission()'s result
+// The driver may read data until pollWrite() stops returning negative, even after the
+// transfer timeout, and no new batch is written or started before then
+template<typename AsyncWire>
+class SerLCD0AsyncI2CTransport {
+public:
+    typedef AsyncWire Port;
+    static const uint8_t DEFAULT_ADDRESS = 0x72;                  // OpenLCD I2C address
+    
+    SerLCD0AsyncI2CTransport(AsyncWire& wire, uint8_t address) : _wire(&wire), _address(address) {}
+    void setPort(AsyncWire& wire) { _wire = &wire; }              // Change I2C driver
+    void begin() {}                                               // Sketch starts the driver
+    bool start(const uint8_t* data, uint8_t len) { return _wire->startWrite(_address, data, len); }
+    SerLCD0Base::TransferStatus poll() {
+        int result = _wire->pollWrite();
+        if(result < 0) {
+            return SerLCD0Base::TransferStatus::BUSY;
+        }
+        return result == 0 ? SerLCD0Base::TransferStatus::DONE    // Zero is ACKed
+                           : SerLCD0Base::TransferStatus::FAILED;
+    }
+
+private:
+    AsyncWire* _wire;                        // Non-blocking I2C driver
+    uint8_t _address;                        // Display address
+};
+
+// Serial (UART) transport, waits for each batch to leave the port like endTransmission()
+// The sketch opens the port at the display's baud rate (OpenLCD default 9600)
+class SerLCD0SerialTransport {
+public:
+    typedef HardwareSerial Port;
+    static const uint8_t DEFAULT_ADDRESS = 0;                     // Unused on a serial link
+    
+    SerLCD0SerialTransport(HardwareSerial& serial, uint8_t) : _serial(&serial) {}
+    void setPort(HardwareSerial& serial) { _serial = &serial; }   // Change serial port
+    void begin() {}                                               // Sketch calls begin(baud)
+    bool start(const uint8_t* data, uint8_t len) {
+        size_t sent = _serial->write(data, len);
+        _serial->flush();                                         // Wait until transmitted
+        return sent == len;
+    }
+    SerLCD0Base::TransferStatus poll() { return SerLCD0Base::TransferStatus::DONE; }
+
+private:
+    HardwareSerial* _serial;                 // Serial port
+};
+
+// SPI transport, address is the chip-select pin. There is no acknowledge on SPI,
+// so a missing panel is not detected
+class SerLCD0SPITransport {
+public:
+    typedef SPIClass Port;
+    static const uint8_t DEFAULT_ADDRESS = 10;                    // Chip-select pin
+    static Port& defaultPort() { return SPI; }
+    
+    SerLCD0SPITransport(SPIClass& spi, uint8_t csPin) : _spi(&spi), _csPin(csPin) {}
+    void setPort(SPIClass& spi) { _spi = &spi; }                  // Change SPI interface
+    void setClock(uint32_t hz) { _clock = hz; }                   // Set SPI clock
+    void begin() {                                                // Sketch calls SPI.begin()
+        pinMode(_csPin, OUTPUT);
+        digitalWrite(_csPin, HIGH);                               // Deselect display
+    }
+    bool start(const uint8_t* data, uint8_t len) {
+        _spi->beginTransaction(SPISettings(_clock, MSBFIRST, SPI_MODE0));
+        digitalWrite(_csPin, LOW);
+        for(uint8_t i = 0; i < len; i++) {
+            _spi->transfer(data[i]);
+        }
+        digitalWrite(_csPin, HIGH);
+        _spi->endTransaction();
+        return true;
+    }
+    SerLCD0Base::TransferStatus poll() { return SerLCD0Base::TransferStatus::DONE; }
+
+private:
+    SPIClass* _spi;                          // SPI interface
+    uint8_t _csPin;                          // Chip-select pin
+    uint32_t _clock = 1000000;               // SPI clock (Hz)
+};
+
+// LCD class with compile-time queue capacity, shadow buffer geometry, producer lock and transport
+// QueueSize is in encoded bytes and must be a power of two so positions wrap with a mask
+// LockPolicy needs lock() and unlock(), and is only used in LOCKED_MPSC mode
+template<uint16_t QueueSize = 256, uint8_t Cols = 20, uint8_t Rows = 4,
+         typename LockPolicy = SerLCD0NoLock, typename Transport = SerLCD0I2CTransport>
+class SerLCD0T : public SerLCD0Base {
+    static_assert(QueueSize >= 8 && QueueSize <= 32768 && (QueueSize & (QueueSize - 1)) == 0,
+                  "SerLCD0T QueueSize must be a power of two");
+    static_assert(Cols > 0 && Rows > 0 && Rows <= 4 && Cols * Rows <= 255,
+                  "SerLCD0T supports up to 4 rows and 255 cells");
+
+public:
+    // Constructor - port and address for the transport (Wire interface and I2C address by default)
+    SerLCD0T(typename Transport::Port& port = Transport::defaultPort(),
+             uint8_t address = Transport::DEFAULT_ADDRESS)
+        : SerLCD0Base(_queueStorage, SERLCD0_LATENCY_STATS ? _stampStorage : nullptr, QueueSize, _frameStorage, _panelStorage, Cols, Rows,
+                      SERLCD0_LOG_MASK ? _logStorage : nullptr),
+          _transport(port, address) {}
+    
+    // Initialize display, optionally over a different port
+    virtual void begin() { _transport.begin(); SerLCD0Base::begin(); }
+    void begin(typename Transport::Port& port) { _transport.setPort(port); begin(); }
+    
+    Transport& transport() { return _transport; }  // Transport settings, e.g. SPI clock
+
+protected:
+    virtual bool startSend(const uint8_t* data, uint8_t len) { return _transport.start(data, len); }
+    virtual TransferStatus pollSend() { return _transport.poll(); }
+    virtual void lockProducers() { _lock.lock(); }      // Serialize producers
+    virtual void unlockProducers() { _lock.unlock(); }
+
+private:
+    LockPolicy _lock;                        // Producer critical section
+    Transport _transport;                    // Link to the display
+    uint8_t _queueStorage[QueueSize];        // Encoded command queue storage
+    uint32_t _stampStorage[SERLCD0_LATENCY_STATS ? QueueSize + LATENCY_WORDS : 1];  // Latency stats
+    SerLCD0Log::Record _logStorage[SERLCD0_LOG_MASK ? LOG_SIZE : 1];  // Debug event ring
+    char _frameStorage[Cols * Rows];         // Wanted display content
+    char _panelStorage[Cols * Rows];         // Known panel content
+};
+
+// Default configuration: 256 byte queue, 20x4 display over I2C
+typedef SerLCD0T<> SerLCD0;
+
+// Same display over serial or SPI
+typedef SerLCD0T<256, 20, 4, SerLCD0NoLock, SerLCD0SerialTransport> SerLCD0Serial;
+typedef SerLCD0T<256, 20, 4, SerLCD0NoLock, SerLCD0SPITransport> SerLCD0SPI;
+
+// Several displays on one bus serviced from one loop() call. Whichever display is ready
+// sends while the others settle, so one display's wait does not leave the bus idle.
+// Only one batch is on the bus at a time, so asynchronous transports can share it too
+class SerLCD0Group {
+public:
+    static const uint8_t MAX_DISPLAYS = 8;       // Displays per group
+    
+    SerLCD0Group() : _count(0), _next(0) {}
+    bool add(SerLCD0Base& lcd);                  // Add display, false if group full
+    uint8_t size() const { return _count; }      // Displays in group
+    bool update();                               // Give every display one turn
+    bool update(unsigned long budgetMicros);     // Keep the bus busy for up to budgetMicros
+
+private:
+    friend class SerLCD0MultiBus;
+    
+    bool sendNext();                             // Offer the bus round robin, true if one sent
+    bool service(uint8_t index);                 // Let one display send, true if it did
+    bool busWait();                              // Poll a transfer in flight, true while busy
+    unsigned long nextSettle() const;            // Shortest settle time still running, 0 if none
+    bool allReady() const;                       // Every display ready
+    
+    SerLCD0Base* _displays[MAX_DISPLAYS];        // Members in the order added
+    uint8_t _count;                              // Displays added
+    uint8_t _next;                               // Display offered the bus first
+};
+
+// Groups on separate buses (Wire, Wire1, Wire2) serviced from one loop() call.
+// With asynchronous transports a batch can be in flight on every bus at once, so
+// throughput grows with the number of buses; blocking transports still take turns
+class SerLCD0MultiBus {
+public:
+    static const uint8_t MAX_BUSES = 4;          // Groups per coordinator
+    
+    SerLCD0MultiBus() : _count(0) {}
+    bool add(SerLCD0Group& group);               // Add one bus's group, false if full
+    uint8_t size() const { return _count; }      // Buses added
+    bool update();                               // Give every bus one turn
+    bool update(unsigned long budgetMicros);     // Keep every bus busy for up to budgetMicros
+
+private:
+    SerLCD0Group* _groups[MAX_BUSES];            // One group per bus
+    uint8_t _count;                              // Groups added
+};
+
 #endif
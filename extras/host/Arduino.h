@@ -0,0 +1,137 @@
+// Arduino.h - Host (Linux g++) stand-in for the Arduino core
+// Provides the subset SerLCD0 and its sketches use: Print, Serial, Serial1 and a
+// simulated clock that only advances when told to, so runs are repeatable
+
+#ifndef SERLCD0_HOST_ARDUINO_H
+#define SERLCD0_HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define DEC 10
+#define HEX 16
+
+#define LOW 0
+#define HIGH 1
+#define INPUT 0
+#define OUTPUT 1
+#define LSBFIRST 0
+#define MSBFIRST 1
+
+class TwoWireDevice;
+
+// Simulated time (microseconds since start)
+unsigned long millis();                          // Simulated milliseconds
+unsigned long micros();                          // Simulated microseconds
+void delay(unsigned long ms);                    // Advance simulated time
+void delayMicroseconds(unsigned int us);         // Advance simulated time
+void hostAdvanceMicros(unsigned long us);        // Advance simulated time
+void hostSetMicros(unsigned long us);            // Jump simulated time (wrap tests)
+void yield();                                    // Busy-wait step: advances 1 us
+
+// Interrupt control and pins are no-ops on the host
+inline void noInterrupts() {}
+inline void interrupts() {}
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t, uint8_t) {}
+
+// Arduino min/max helpers
+template<class T, class L> inline auto min(const T& a, const L& b) -> decltype(a < b ? a : b) {
+    return (b < a) ? b : a;
+}
+template<class T, class L> inline auto max(const T& a, const L& b) -> decltype(a < b ? a : b) {
+    return (a < b) ? b : a;
+}
+
+// Character output base class, same virtual interface as ArduinoCore-API
+class Print {
+public:
+    virtual ~Print() {}
+    
+    virtual size_t write(uint8_t) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size) {
+        size_t n = 0;
+        while(size--) {
+            if(write(*buffer++)) n++;
+            else break;
+        }
+        return n;
+    }
+    size_t write(const char* str) {
+        return str ? write((const uint8_t*)str, strlen(str)) : 0;
+    }
+    size_t write(const char* buffer, size_t size) {
+        return write((const uint8_t*)buffer, size);
+    }
+    virtual int availableForWrite() { return 0; }
+    virtual void flush() {}
+    
+    size_t print(const char* str) { return write(str); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(unsigned char n, int base = DEC) { return print((unsigned long)n, base); }
+    size_t print(int n, int base = DEC) { return print((long)n, base); }
+    size_t print(unsigned int n, int base = DEC) { return print((unsigned long)n, base); }
+    size_t print(long n, int base = DEC) {
+        if(n < 0 && base == DEC) {
+            return print('-') + print((unsigned long)-n, base);
+        }
+        return print((unsigned long)n, base);
+    }
+    size_t print(unsigned long n, int base = DEC) {
+        char buf[24];
+        snprintf(buf, sizeof(buf), base == HEX ? "%lX" : "%lu", n);
+        return write(buf);
+    }
+    size_t print(double n, int digits = 2) {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%.*f", digits, n);
+        return write(buf);
+    }
+    
+    size_t println() { return write("\r\n"); }
+    template<class T> size_t println(T value) { size_t n = print(value); return n + println(); }
+    template<class T> size_t println(T value, int format) { size_t n = print(value, format); return n + println(); }
+};
+
+// Serial port that writes to stdout (or nowhere when muted), or with a device
+// attached, delivers what was written on flush() and charges 10 bit times per byte
+class HardwareSerial : public Print {
+public:
+    void begin(unsigned long baud) { _baud = baud; }
+    void setOutput(FILE* out) { _out = out; }    // nullptr mutes output
+    virtual size_t write(uint8_t c);
+    using Print::write;
+    virtual int availableForWrite() { return 256; }
+    virtual void flush();
+    int available() { return 0; }
+    int read() { return -1; }
+    operator bool() const { return true; }
+    
+    // Simulation control and statistics, as on TwoWire
+    void attach(TwoWireDevice* device) { _device = device; }  // Receive writes instead of stdout
+    unsigned long byteMicros() const { return (10UL * 1000000UL + _baud - 1) / _baud; }
+    unsigned long transactions() const { return _transactions; }
+    unsigned long bytesSent() const { return _bytesSent; }
+    unsigned long busMicros() const { return _busMicros; }
+    void resetStats() { _transactions = 0; _bytesSent = 0; _busMicros = 0; }
+
+private:
+    FILE* _out = stdout;
+    unsigned long _baud = 9600;
+    TwoWireDevice* _device = nullptr;
+    uint8_t _buffer[256];                        // Written since last flush()
+    size_t _length = 0;
+    unsigned long _transactions = 0;
+    unsigned long _bytesSent = 0;
+    unsigned long _busMicros = 0;
+};
+
+extern HardwareSerial Serial;
+extern HardwareSerial Serial1;
+
+#endif
@@ -0,0 +1,214 @@
+// ArduinoHost.cpp - Simulated clock, Serial, TwoWire and SPI for host builds
+
+#include "Arduino.h"
+#include "Wire.h"
+#include "SPI.h"
+
+// Simulated time, advanced only by the harness and by bus transfers
+static unsigned long hostMicros = 0;
+
+unsigned long millis() { return hostMicros / 1000; }
+unsigned long micros() { return hostMicros; }
+void delay(unsigned long ms) { hostMicros += ms * 1000; }
+void delayMicroseconds(unsigned int us) { hostMicros += us; }
+void hostAdvanceMicros(unsigned long us) { hostMicros += us; }
+void hostSetMicros(unsigned long us) { hostMicros = us; }
+void yield() { hostMicros++; }                   // Spin loops would never end otherwise
+
+HardwareSerial Serial;
+HardwareSerial Serial1;
+TwoWire Wire;
+TwoWire Wire1;
+TwoWire Wire2;
+
+// Start collecting a write transaction
+void TwoWire::beginTransmission(uint8_t address) {
+    _address = address;
+    _length = 0;
+    _overflow = false;
+}
+
+// Buffer one byte, fails once the TX buffer is full
+size_t TwoWire::write(uint8_t data) {
+    if(_length >= BUFFER_LENGTH) {
+        _overflow = true;
+        return 0;
+    }
+    _buffer[_length++] = data;
+    return 1;
+}
+
+// Buffer several bytes, returns how many fit
+size_t TwoWire::write(const uint8_t* data, size_t len) {
+    size_t n = 0;
+    while(n < len && write(data[n])) {
+        n++;
+    }
+    return n;
+}
+
+// Bus time for one byte plus its ACK bit
+unsigned long TwoWire::byteMicros() const {
+    return (9UL * 1000000UL + _clock - 1) / _clock;
+}
+
+// Deliver transaction to the addressed device and charge bus time (blocking, like the R4)
+uint8_t TwoWire::endTransmission(bool sendStop) {
+    (void)sendStop;
+    unsigned long duration;
+    uint8_t result = deliver(micros(), duration);
+    hostAdvanceMicros(duration);
+    return result;
+}
+
+// Start a write that runs in the background, as an interrupt or DMA driven driver would.
+// The device sees it at once with its bus timing, pollWrite() reports when it is done
+bool TwoWire::startWrite(uint8_t address, const uint8_t* data, uint8_t len) {
+    if(pollWrite() < 0) {
+        return false;                        // Previous write still on the bus
+    }
+    beginTransmission(address);
+    write(data, len);
+    _asyncStart = micros();
+    if(_stallCount > 0) {
+        _stallCount--;                       // Device holds the clock low, nothing arrives
+        _transactions++;
+        _asyncMicros = STALL_MICROS;
+        _asyncResult = 5;                    // Then the driver gives up with a timeout
+        return true;
+    }
+    _asyncResult = deliver(_asyncStart, _asyncMicros);
+    return true;
+}
+
+// Negative while the last startWrite() is in flight, then its endTransmission() code
+int TwoWire::pollWrite() {
+    if(micros() - _asyncStart < _asyncMicros) {
+        return -1;
+    }
+    return _asyncResult;
+}
+
+// Hand the buffered transaction to the addressed device, returns the endTransmission()
+// code and sets duration to the bus time it takes
+uint8_t TwoWire::deliver(unsigned long start, unsigned long& duration) {
+    duration = 0;
+    if(_overflow) {
+        return 1;                            // Data too long for buffer
+    }
+    
+    unsigned long perByte = byteMicros();
+    _transactions++;
+    
+    TwoWireDevice* device = nullptr;
+    for(uint8_t i = 0; i < MAX_DEVICES; i++) {
+        if(_devices[i] && _addresses[i] == _address) {
+            device = _devices[i];
+        }
+    }
+    
+    duration = perByte;                      // Address NACKed or nobody answered it
+    if(_failCount > 0) {
+        _failCount--;
+        _busMicros += duration;
+        return 2;
+    }
+    if(!device) {
+        _busMicros += duration;
+        return 2;
+    }
+    
+    duration = (_length + 1) * perByte + 2 * perByte / 9;  // Address, data, start/stop
+    _busMicros += duration;
+    if(!device->onReceive(_buffer, _length, start, perByte)) {
+        return 3;                            // Data NACK
+    }
+    _bytesSent += _length;
+    return 0;
+}
+
+// Connect a device at an address, replacing any device already there
+void TwoWire::attach(uint8_t address, TwoWireDevice* device) {
+    detach(address);
+    for(uint8_t i = 0; i < MAX_DEVICES; i++) {
+        if(!_devices[i]) {
+            _addresses[i] = address;
+            _devices[i] = device;
+            return;
+        }
+    }
+}
+
+// Remove the device at an address (simulates unplugging the cable)
+void TwoWire::detach(uint8_t address) {
+    for(uint8_t i = 0; i < MAX_DEVICES; i++) {
+        if(_devices[i] && _addresses[i] == address) {
+            _devices[i] = nullptr;
+        }
+    }
+}
+
+// Print to stdout, or buffer for the attached device until flush()
+size_t HardwareSerial::write(uint8_t c) {
+    if(_device) {
+        if(_length >= sizeof(_buffer)) {
+            flush();                             // TX buffer full, wait for it to drain
+        }
+        _buffer[_length++] = c;
+        return 1;
+    }
+    if(_out && c != '\r') fputc(c, _out);
+    return 1;
+}
+
+// Send buffered bytes to the attached device, blocking for their wire time
+void HardwareSerial::flush() {
+    if(!_device || _length == 0) {
+        return;
+    }
+    unsigned long perByte = byteMicros();
+    unsigned long duration = _length * perByte;
+    _device->onReceive(_buffer, _length, micros() - perByte, perByte);
+    hostAdvanceMicros(duration);
+    _transactions++;
+    _bytesSent += _length;
+    _busMicros += duration;
+    _length = 0;
+}
+
+SPIClass SPI;
+
+// Start collecting a transaction at the given clock
+void SPIClass::beginTransaction(SPISettings settings) {
+    _clock = settings.clock;
+    _length = 0;
+}
+
+// Buffer one byte, the display never answers so 0 comes back
+uint8_t SPIClass::transfer(uint8_t data) {
+    if(_length < BUFFER_SIZE) {
+        _buffer[_length++] = data;
+    }
+    return 0;
+}
+
+// Bus time for one byte
+unsigned long SPIClass::byteMicros() const {
+    return (8UL * 1000000UL + _clock - 1) / _clock;
+}
+
+// Deliver transaction to the device and charge bus time (blocking)
+void SPIClass::endTransaction() {
+    unsigned long perByte = byteMicros();
+    unsigned long duration = _length * perByte;
+    _transactions++;
+    _busMicros += duration;
+    if(_failCount > 0) {
+        _failCount--;                            // Lost, SPI cannot tell
+    } else if(_device) {
+        _device->onReceive(_buffer, _length, micros() - perByte, perByte);
+        _bytesSent += _length;
+    }
+    hostAdvanceMicros(duration);
+    _length = 0;
+}
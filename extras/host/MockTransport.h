@@ -0,0 +1,69 @@
+// MockTransport.h - SerLCD0 transport policy for host tests, no bus in between
+// Each batch goes straight to an attached device (normally an OpenLCDEmulator) at a
+// configurable cost per byte. Batches are counted and can be made to fail on demand
+//   MockLink link;
+//   link.attach(&panel);
+//   SerLCD0T<256, 20, 4, SerLCD0NoLock, SerLCD0MockTransport> lcd(link);
+
+#ifndef SERLCD0_HOST_MOCK_TRANSPORT_H
+#define SERLCD0_HOST_MOCK_TRANSPORT_H
+
+#include "Arduino.h"
+#include "Wire.h"                                // TwoWireDevice
+#include "SerLCD0.h"
+
+// The link a mock transport sends over
+class MockLink {
+public:
+    void attach(TwoWireDevice* device) { _device = device; }    // Device receiving batches
+    void failNext(uint8_t count) { _failCount = count; }        // Fail next sends
+    void setByteMicros(unsigned long us) { _byteMicros = us; }  // Cost per byte, 0 for none
+    unsigned long byteMicros() const { return _byteMicros; }
+    
+    // Hand a batch to the device, true if it took it
+    bool deliver(const uint8_t* data, uint8_t len) {
+        _transactions++;
+        if(_failCount > 0 || !_device) {
+            if(_failCount > 0) _failCount--;
+            return false;
+        }
+        unsigned long duration = len * _byteMicros;
+        bool ok = _device->onReceive(data, len, micros() - _byteMicros, _byteMicros);
+        hostAdvanceMicros(duration);
+        _busMicros += duration;
+        if(ok) _bytesSent += len;
+        return ok;
+    }
+    
+    // Statistics, as on TwoWire
+    unsigned long transactions() const { return _transactions; }
+    unsigned long bytesSent() const { return _bytesSent; }
+    unsigned long busMicros() const { return _busMicros; }
+    void resetStats() { _transactions = 0; _bytesSent = 0; _busMicros = 0; }
+
+private:
+    TwoWireDevice* _device = nullptr;
+    unsigned long _byteMicros = 0;
+    uint8_t _failCount = 0;
+    unsigned long _transactions = 0;
+    unsigned long _bytesSent = 0;
+    unsigned long _busMicros = 0;
+};
+
+// Transport policy over a MockLink, the address is ignored
+class SerLCD0MockTransport {
+public:
+    typedef MockLink Port;
+    static const uint8_t DEFAULT_ADDRESS = 0;
+    
+    SerLCD0MockTransport(MockLink& link, uint8_t) : _link(&link) {}
+    void setPort(MockLink& link) { _link = &link; }
+    void begin() {}
+    bool start(const uint8_t* data, uint8_t len) { return _link->deliver(data, len); }
+    SerLCD0Base::TransferStatus poll() { return SerLCD0Base::TransferStatus::DONE; }
+
+private:
+    MockLink* _link;
+};
+
+#endif
@@ -0,0 +1,223 @@
+// OpenLCDEmulator.cpp - Host model of a SparkFun OpenLCD (SerLCD) panel
+
+#include "OpenLCDEmulator.h"
+
+// HD44780 memory offset for each row
+static const uint8_t row_offsets[] = { 0x00, 0x40, 0x14, 0x54 };
+
+OpenLCDEmulator::OpenLCDEmulator(const OpenLCDTiming& timing) : _timing(timing) {
+    reset();
+}
+
+// Power cycle: blank screen, white backlight, parser idle
+void OpenLCDEmulator::reset() {
+    memset(_ddram, ' ', sizeof(_ddram));
+    memset(_visibleAt, 0, sizeof(_visibleAt));
+    _address = 0;
+    _rgb[0] = _rgb[1] = _rgb[2] = 255;
+    _displayOn = true;
+    _mode = Mode::NORMAL;
+    _rgbIndex = 0;
+    _pending.clear();
+    _busyUntil = 0;
+    resetStats();
+}
+
+// Zero counters without touching the screen
+void OpenLCDEmulator::resetStats() {
+    _bytesReceived = 0;
+    _charsWritten = 0;
+    _commands = 0;
+    _clears = 0;
+    _backlightChanges = 0;
+    _droppedBytes = 0;
+    _maxBacklog = 0;
+}
+
+// Report visible cell and backlight changes to a harness
+void OpenLCDEmulator::setObservers(OpenLCDCharObserver onChar, OpenLCDBacklightObserver onBacklight,
+                                   void* context) {
+    _onChar = onChar;
+    _onBacklight = onBacklight;
+    _observerContext = context;
+}
+
+// Bytes of an I2C write arrive one bus byte-time apart after the address byte
+bool OpenLCDEmulator::onReceive(const uint8_t* data, size_t len,
+                                unsigned long startMicros, unsigned long byteMicros) {
+    for(size_t i = 0; i < len; i++) {
+        receiveByte(data[i], startMicros + (i + 2) * byteMicros);
+    }
+    return true;
+}
+
+// Buffer one byte, or drop it if the firmware receive buffer is full
+void OpenLCDEmulator::receiveByte(uint8_t b, unsigned long arrival) {
+    _bytesReceived++;
+    
+    // Bytes whose processing finished before this one arrived leave the buffer
+    while(!_pending.empty() && _pending.front() <= arrival) {
+        _pending.pop_front();
+    }
+    if(_pending.size() >= _timing.rxBufferSize) {
+        _droppedBytes++;                             // Overrun, byte lost
+        return;
+    }
+    
+    decode(b, arrival);
+    if(_pending.size() > _maxBacklog) {
+        _maxBacklog = _pending.size();
+    }
+}
+
+// Queue processing of a byte behind earlier work, returns its completion time
+unsigned long OpenLCDEmulator::finish(unsigned long arrival, unsigned long cost) {
+    unsigned long start = (_busyUntil > arrival) ? _busyUntil : arrival;
+    _busyUntil = start + cost;
+    _pending.push_back(_busyUntil);
+    return _busyUntil;
+}
+
+// OpenLCD command parser, using SerLCD0's convention that a doubled prefix is a literal
+void OpenLCDEmulator::decode(uint8_t b, unsigned long arrival) {
+    switch(_mode) {
+        case Mode::NORMAL:
+            if(b == 254) {
+                _mode = Mode::SPECIAL;
+                finish(arrival, 0);
+            } else if(b == 0x7C) {
+                _mode = Mode::SETTING;
+                finish(arrival, 0);
+            } else {
+                putChar(b, finish(arrival, _timing.charMicros));
+            }
+            break;
+            
+        case Mode::SPECIAL:
+            _mode = Mode::NORMAL;
+            if(b == 254) {
+                putChar(b, finish(arrival, _timing.charMicros));  // Escaped literal
+            } else {
+                lcdCommand(b, arrival);
+            }
+            break;
+            
+        case Mode::SETTING:
+            if(b == 0x7C) {
+                _mode = Mode::NORMAL;
+                putChar(b, finish(arrival, _timing.charMicros));  // Escaped literal
+            } else if(b == 0x2B) {
+                _mode = Mode::RGB;                   // Collect red, green, blue
+                _rgbIndex = 0;
+                finish(arrival, 0);
+            } else {
+                _mode = Mode::NORMAL;
+                _commands++;                         // Other settings are accepted and ignored
+                finish(arrival, _timing.settingMicros);
+            }
+            break;
+            
+        case Mode::RGB:
+            _rgbPending[_rgbIndex++] = b;
+            if(_rgbIndex < 3) {
+                finish(arrival, 0);
+            } else {
+                memcpy(_rgb, _rgbPending, 3);
+                _mode = Mode::NORMAL;
+                _commands++;
+                _backlightChanges++;
+                unsigned long done = finish(arrival, _timing.settingMicros);
+                if(_onBacklight) {
+                    _onBacklight(_observerContext, _rgb[0], _rgb[1], _rgb[2], done);
+                }
+            }
+            break;
+    }
+}
+
+// Write character at cursor and advance through DDRAM like the HD44780
+void OpenLCDEmulator::putChar(uint8_t c, unsigned long visible) {
+    _ddram[_address] = c;
+    _visibleAt[_address] = visible;
+    _charsWritten++;
+    
+    // Report writes that land on the visible 20x4 area
+    if(_onChar) {
+        for(uint8_t row = 0; row < ROWS; row++) {
+            if(_address >= row_offsets[row] && _address < row_offsets[row] + COLS) {
+                _onChar(_observerContext, _address - row_offsets[row], row, c, visible);
+            }
+        }
+    }
+    
+    // Line 1 runs 0x00-0x27 and line 2 0x40-0x67, each wrapping into the other
+    _address++;
+    if(_address == 0x28) _address = 0x40;
+    else if(_address == 0x68) _address = 0x00;
+}
+
+// HD44780 instruction sent after the 254 prefix
+void OpenLCDEmulator::lcdCommand(uint8_t c, unsigned long arrival) {
+    _commands++;
+    if(c & 0x80) {                                   // Set DDRAM address
+        _address = c & 0x7F;
+        finish(arrival, _timing.commandMicros);
+    } else if(c == 0x01) {                           // Clear display
+        memset(_ddram, ' ', sizeof(_ddram));
+        unsigned long done = finish(arrival, _timing.clearMicros);
+        for(uint8_t i = 0; i < sizeof(_visibleAt) / sizeof(_visibleAt[0]); i++) {
+            _visibleAt[i] = done;
+        }
+        _address = 0;
+        _clears++;
+    } else if((c & 0xFE) == 0x02) {                  // Return home
+        _address = 0;
+        finish(arrival, _timing.clearMicros);
+    } else if((c & 0xF8) == 0x08) {                  // Display on/off control
+        _displayOn = (c & 0x04) != 0;
+        finish(arrival, _timing.commandMicros);
+    } else {
+        finish(arrival, _timing.commandMicros);      // Entry mode, shift, CGRAM: ignored
+    }
+}
+
+// Character shown at a cell
+char OpenLCDEmulator::charAt(uint8_t col, uint8_t row) const {
+    if(col >= COLS || row >= ROWS) return ' ';
+    return (char)_ddram[row_offsets[row] + col];
+}
+
+// Row as printable text: block characters become '#', other non-ASCII '?'
+void OpenLCDEmulator::rowText(uint8_t row, char* out) const {
+    for(uint8_t col = 0; col < COLS; col++) {
+        uint8_t c = (uint8_t)charAt(col, row);
+        out[col] = (c == 0xFF) ? '#' : (c >= 0x20 && c < 0x7F) ? (char)c : '?';
+    }
+    out[COLS] = '\0';
+}
+
+// Compare the start of a row with text
+bool OpenLCDEmulator::rowEquals(uint8_t row, const char* text) const {
+    for(uint8_t col = 0; col < COLS && text[col]; col++) {
+        if(charAt(col, row) != text[col]) return false;
+    }
+    return true;
+}
+
+// Time the firmware finished writing a cell
+unsigned long OpenLCDEmulator::cellVisibleAt(uint8_t col, uint8_t row) const {
+    if(col >= COLS || row >= ROWS) return 0;
+    return _visibleAt[row_offsets[row] + col];
+}
+
+// Draw framed screen with backlight colour
+void OpenLCDEmulator::printScreen(FILE* out) const {
+    char text[COLS + 1];
+    fprintf(out, "+--------------------+ RGB(%u,%u,%u)%s\n",
+            _rgb[0], _rgb[1], _rgb[2], _displayOn ? "" : " display off");
+    for(uint8_t row = 0; row < ROWS; row++) {
+        rowText(row, text);
+        fprintf(out, "|%s|\n", text);
+    }
+    fprintf(out, "+--------------------+\n");
+}
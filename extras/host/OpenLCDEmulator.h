@@ -0,0 +1,106 @@
+// OpenLCDEmulator.h - Host model of a SparkFun OpenLCD (SerLCD) 20x4 panel
+// Decodes the 254 / 0x7C command stream into an HD44780 character grid and
+// backlight state, and models firmware processing time with a receive buffer
+// that drops bytes when the sender outruns it
+
+#ifndef OPENLCD_EMULATOR_H
+#define OPENLCD_EMULATOR_H
+
+#include <deque>
+#include "Arduino.h"
+#include "Wire.h"
+
+// Firmware processing cost per decoded command (microseconds)
+struct OpenLCDTiming {
+    unsigned long charMicros = 60;           // Write one character
+    unsigned long commandMicros = 60;        // Cursor, home, display control
+    unsigned long clearMicros = 2000;        // Clear display
+    unsigned long settingMicros = 3000;      // Settings and backlight (EEPROM write)
+    uint16_t rxBufferSize = 64;              // Firmware receive buffer (bytes)
+};
+
+// Callbacks when a visible cell or the backlight changes (time is when firmware finishes)
+typedef void (*OpenLCDCharObserver)(void* context, uint8_t col, uint8_t row,
+                                    uint8_t c, unsigned long visibleMicros);
+typedef void (*OpenLCDBacklightObserver)(void* context, uint8_t r, uint8_t g, uint8_t b,
+                                         unsigned long visibleMicros);
+
+class OpenLCDEmulator : public TwoWireDevice {
+public:
+    explicit OpenLCDEmulator(const OpenLCDTiming& timing = OpenLCDTiming());
+    
+    // TwoWireDevice interface
+    virtual bool onReceive(const uint8_t* data, size_t len,
+                           unsigned long startMicros, unsigned long byteMicros);
+    
+    // Feed one byte arriving at a given time (for non-I2C transports)
+    void receiveByte(uint8_t b, unsigned long arrivalMicros);
+    
+    void reset();                                    // Power cycle: blank screen, white backlight
+    void resetStats();                               // Zero counters only
+    void setObservers(OpenLCDCharObserver onChar, OpenLCDBacklightObserver onBacklight,
+                      void* context);                // Report visible changes
+    
+    // Screen contents
+    static const uint8_t COLS = 20;
+    static const uint8_t ROWS = 4;
+    char charAt(uint8_t col, uint8_t row) const;     // Character shown at a cell
+    void rowText(uint8_t row, char* out) const;      // Row as printable text (COLS + 1 bytes)
+    bool rowEquals(uint8_t row, const char* text) const;  // Compare start of row with text
+    unsigned long cellVisibleAt(uint8_t col, uint8_t row) const;  // When cell was last written
+    uint8_t cursorAddress() const { return _address; }
+    void printScreen(FILE* out) const;               // Draw framed screen and backlight
+    
+    // Backlight and display state
+    uint8_t red() const { return _rgb[0]; }
+    uint8_t green() const { return _rgb[1]; }
+    uint8_t blue() const { return _rgb[2]; }
+    bool displayOn() const { return _displayOn; }
+    
+    // Statistics
+    unsigned long bytesReceived() const { return _bytesReceived; }
+    unsigned long charsWritten() const { return _charsWritten; }
+    unsigned long commands() const { return _commands; }
+    unsigned long clears() const { return _clears; }
+    unsigned long backlightChanges() const { return _backlightChanges; }
+    unsigned long droppedBytes() const { return _droppedBytes; }  // Receive buffer overruns
+    uint16_t maxBacklog() const { return _maxBacklog; }           // Deepest receive buffer use
+    unsigned long busyUntil() const { return _busyUntil; }        // Firmware idle after this time
+
+private:
+    enum class Mode { NORMAL, SPECIAL, SETTING, RGB };
+    
+    void decode(uint8_t b, unsigned long arrival);   // Run firmware command parser
+    unsigned long finish(unsigned long arrival, unsigned long cost);  // Schedule processing
+    void putChar(uint8_t c, unsigned long visible);  // Store character at cursor
+    void lcdCommand(uint8_t c, unsigned long arrival);  // HD44780 instruction
+    
+    OpenLCDTiming _timing;
+    
+    uint8_t _ddram[128];                             // HD44780 display RAM
+    unsigned long _visibleAt[128];                   // Completion time per DDRAM cell
+    uint8_t _address;                                // DDRAM cursor address
+    uint8_t _rgb[3];                                 // Backlight colour
+    bool _displayOn;                                 // Display enabled
+    
+    Mode _mode;                                      // Parser state
+    uint8_t _rgbIndex;                               // Next RGB byte to collect
+    uint8_t _rgbPending[3];                          // RGB bytes collected so far
+    
+    OpenLCDCharObserver _onChar = nullptr;           // Visible cell change callback
+    OpenLCDBacklightObserver _onBacklight = nullptr; // Backlight change callback
+    void* _observerContext = nullptr;
+    
+    std::deque<unsigned long> _pending;              // Completion times of buffered bytes
+    unsigned long _busyUntil;                        // Time firmware finishes current work
+    
+    unsigned long _bytesReceived;
+    unsigned long _charsWritten;
+    unsigned long _commands;
+    unsigned long _clears;
+    unsigned long _backlightChanges;
+    unsigned long _droppedBytes;
+    uint16_t _maxBacklog;
+};
+
+#endif
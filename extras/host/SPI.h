@@ -0,0 +1,62 @@
+// SPI.h - Host (Linux g++) stand-in for the Arduino SPIClass
+// Bytes transferred inside a transaction are delivered to the attached device at
+// endTransaction() and charge 8 clocks per byte. Chip select is not modelled
+
+#ifndef SERLCD0_HOST_SPI_H
+#define SERLCD0_HOST_SPI_H
+
+#include "Arduino.h"
+#include "Wire.h"                                // TwoWireDevice
+
+#define SPI_MODE0 0x00
+#define SPI_MODE1 0x04
+#define SPI_MODE2 0x08
+#define SPI_MODE3 0x0C
+
+class SPISettings {
+public:
+    SPISettings(uint32_t clock = 4000000, uint8_t bitOrder = MSBFIRST, uint8_t dataMode = SPI_MODE0)
+        : clock(clock), bitOrder(bitOrder), dataMode(dataMode) {}
+    uint32_t clock;
+    uint8_t bitOrder;
+    uint8_t dataMode;
+};
+
+class SPIClass {
+public:
+    void begin() {}
+    void end() {}
+    
+    // Transfer interface used by SerLCD0
+    void beginTransaction(SPISettings settings);
+    uint8_t transfer(uint8_t data);
+    void endTransaction();
+    
+    // Simulation control
+    void attach(TwoWireDevice* device) { _device = device; }  // Device on the bus
+    void failNext(uint8_t count) { _failCount = count; }      // Drop next transactions
+    unsigned long byteMicros() const;                         // Bus time per byte
+    
+    // Bus statistics
+    unsigned long transactions() const { return _transactions; }
+    unsigned long bytesSent() const { return _bytesSent; }
+    unsigned long busMicros() const { return _busMicros; }
+    void resetStats() { _transactions = 0; _bytesSent = 0; _busMicros = 0; }
+
+private:
+    static const uint16_t BUFFER_SIZE = 256;
+    
+    uint32_t _clock = 4000000;               // Clock of current transaction (Hz)
+    uint8_t _buffer[BUFFER_SIZE];            // Bytes of current transaction
+    uint16_t _length = 0;
+    TwoWireDevice* _device = nullptr;        // Attached device
+    uint8_t _failCount = 0;                  // Dropped transactions remaining
+    
+    unsigned long _transactions = 0;
+    unsigned long _bytesSent = 0;
+    unsigned long _busMicros = 0;
+};
+
+extern SPIClass SPI;
+
+#endif
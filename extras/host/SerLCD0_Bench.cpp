@@ -0,0 +1,874 @@
+// SerLCD0_Bench.cpp - Throughput and latency benchmarks against the OpenLCD emulator
+// Drives SerLCD0 through representative workloads on a simulated I2C, SPI or serial
+// link (or the mock transport) and reports
+// characters/second, bytes on the wire, update() calls, time spent inside update() and
+// enqueue-to-visible latency
+// Build and run from the library root (one command line):
+//   g++ -std=gnu++17 -O2 -pthread -I extras/host -I . SerLCD0.cpp extras/host/ArduinoHost.cpp
+//       extras/host/OpenLCDEmulator.cpp extras/host/SerLCD0_Bench.cpp -o serlcd0_bench
+//   ./serlcd0_bench [--shadow] [--clock hz] [--budget us] [--char-time us] [--cmd-time us]
+//       [--drop-oldest] [--bus i2c|i2c-async|spi|serial|mock] [workload ...]
+// Add -DSERLCD0_LATENCY_STATS=1 to also print the library's own queue wait histograms
+// Exits with status 1 if the spsc or mpsc workload loses, reorders or tears any character
+
+#include <stdlib.h>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Arduino.h"
+#include "Wire.h"
+#include "SPI.h"
+#include "SerLCD0.h"
+#include "OpenLCDEmulator.h"
+#include "MockTransport.h"
+
+static const unsigned long LOOP_MICROS = 50;         // Simulated cost of one loop() pass
+static const unsigned long DRAIN_LIMIT = 30000000;   // Give up draining after 30 s
+
+// Producer lock for the multi-producer workload
+struct BenchMutex {
+    std::mutex m;
+    void lock() { m.lock(); }
+    void unlock() { m.unlock(); }
+};
+
+// Display types for each bus, the lock is only taken in LOCKED_MPSC mode
+typedef SerLCD0T<256, 20, 4, BenchMutex> BenchI2CLCD;
+typedef SerLCD0T<256, 20, 4, BenchMutex, SerLCD0AsyncI2CTransport<TwoWire> > BenchAsyncLCD;
+typedef SerLCD0T<256, 20, 4, BenchMutex, SerLCD0SPITransport> BenchSPILCD;
+typedef SerLCD0T<256, 20, 4, BenchMutex, SerLCD0SerialTransport> BenchSerialLCD;
+typedef SerLCD0T<256, 20, 4, BenchMutex, SerLCD0MockTransport> BenchMockLCD;
+
+// Link between display and emulator
+enum class BenchBus { I2C, I2C_ASYNC, SPI, SERIAL, MOCK };
+
+// Options shared by all workloads
+struct BenchOptions {
+    BenchBus bus = BenchBus::I2C;                    // Transport under test
+    bool shadow = false;                             // Use shadow framebuffer
+    unsigned long budget = 0;                        // update(budget) slice, 0 for update()
+    long charTime = -1;                              // setCharTimeMicros() value, -1 for default
+    long cmdTime = -1;                               // setCmdTimeMicros() value, -1 for default
+    bool dropOldest = false;                         // Full queue drops oldest instead of newest
+};
+
+// Tracks time from queueing a character or colour until the panel shows it.
+// Values overwritten before they became visible are not counted
+class LatencyTracker {
+public:
+    explicit LatencyTracker(const OpenLCDEmulator& panel) : _panel(panel) {
+        memset(_pending, 0, sizeof(_pending));
+    }
+
+    // Record characters queued at a position; ones the panel already shows are not tracked
+    void noteText(uint8_t col, uint8_t row, const char* text, size_t len) {
+        for(size_t i = 0; i < len && col + i < OpenLCDEmulator::COLS; i++) {
+            Pending& cell = _pending[row][col + i];
+            cell.c = (uint8_t)text[i];
+            cell.queuedAt = micros();
+            cell.active = (_panel.charAt(col + i, row) != text[i]);
+        }
+    }
+
+    // Record a backlight colour queued now
+    void noteBacklight(uint8_t r, uint8_t g, uint8_t b) {
+        _rgb[0] = r; _rgb[1] = g; _rgb[2] = b;
+        _rgbQueuedAt = micros();
+        _rgbActive = true;
+    }
+
+    // Emulator callbacks
+    static void onChar(void* context, uint8_t col, uint8_t row, uint8_t c, unsigned long visible) {
+        LatencyTracker* self = (LatencyTracker*)context;
+        Pending& cell = self->_pending[row][col];
+        if(cell.active && cell.c == c) {
+            self->_samples.push_back(visible - cell.queuedAt);
+            cell.active = false;
+        }
+    }
+    static void onBacklight(void* context, uint8_t r, uint8_t g, uint8_t b, unsigned long visible) {
+        LatencyTracker* self = (LatencyTracker*)context;
+        if(self->_rgbActive && r == self->_rgb[0] && g == self->_rgb[1] && b == self->_rgb[2]) {
+            self->_samples.push_back(visible - self->_rgbQueuedAt);
+            self->_rgbActive = false;
+        }
+    }
+
+    // Latency percentile in milliseconds (p in 0-100)
+    double percentile(double p) {
+        if(_samples.empty()) return 0;
+        std::sort(_samples.begin(), _samples.end());
+        size_t index = (size_t)((p / 100.0) * (_samples.size() - 1) + 0.5);
+        return _samples[index] / 1000.0;
+    }
+    size_t count() const { return _samples.size(); }
+    
+    // Characters queued but never shown and not replaced by a newer value
+    unsigned long lost() const {
+        unsigned long n = 0;
+        for(uint8_t row = 0; row < OpenLCDEmulator::ROWS; row++) {
+            for(uint8_t col = 0; col < OpenLCDEmulator::COLS; col++) {
+                if(_pending[row][col].active) n++;
+            }
+        }
+        return n;
+    }
+
+private:
+    struct Pending {
+        uint8_t c;
+        unsigned long queuedAt;
+        bool active;
+    };
+    const OpenLCDEmulator& _panel;
+    Pending _pending[OpenLCDEmulator::ROWS][OpenLCDEmulator::COLS];
+    uint8_t _rgb[3] = {};
+    unsigned long _rgbQueuedAt = 0;
+    bool _rgbActive = false;
+    std::vector<unsigned long> _samples;
+};
+
+// One display, one emulated panel and the counters a workload run produces
+struct Bench {
+    OpenLCDEmulator panel;
+    MockLink link;
+    BenchI2CLCD i2cLcd;
+    BenchAsyncLCD asyncLcd;
+    BenchSPILCD spiLcd;
+    BenchSerialLCD serialLcd;
+    BenchMockLCD mockLcd;
+    SerLCD0Base& lcd;                                // The one on the bus under test
+    BenchBus bus;
+    LatencyTracker latency;
+    unsigned long updates = 0;                       // update() calls made
+    unsigned long updateMicros = 0;                  // Time loop() spent inside update()
+    unsigned long rejected = 0;                      // Characters the queue refused
+    unsigned long resets = 0;                        // Entries into the ERROR state
+    bool inError = false;
+    unsigned long startMicros = 0;                   // First command queued
+
+    unsigned long budget;                            // update() time slice (0 = single pass)
+
+    Bench(uint32_t clock, const BenchOptions& options)
+        : i2cLcd(Wire1), asyncLcd(Wire1), spiLcd(SPI), serialLcd(Serial1), mockLcd(link),
+          lcd(select(options.bus)), bus(options.bus), latency(panel), budget(options.budget) {
+        hostSetMicros(0);
+        Wire1.setClock(clock);
+        Wire1.attach(0x72, &panel);
+        spiLcd.transport().setClock(clock);
+        SPI.attach(&panel);
+        Serial1.begin(clock);
+        Serial1.attach(&panel);
+        link.attach(&panel);
+        resetBusStats();
+        panel.setObservers(LatencyTracker::onChar, LatencyTracker::onBacklight, &latency);
+        lcd.begin();
+        if(options.charTime >= 0) {
+            lcd.setCharTimeMicros(options.charTime);
+        }
+        if(options.cmdTime >= 0) {
+            lcd.setCmdTimeMicros(options.cmdTime);
+        }
+        if(options.dropOldest) {
+            lcd.setOverflowPolicy(SerLCD0::OverflowPolicy::DROP_OLDEST);
+        }
+        if(options.shadow) {
+            lcd.enableShadowBuffer();
+        }
+        drain();                                     // Initial clear and backlight
+        resetBusStats();
+        lcd.resetLatencyStats();
+        panel.resetStats();
+        updates = 0;
+        updateMicros = 0;
+        startMicros = micros();
+    }
+
+    // Display for a bus
+    SerLCD0Base& select(BenchBus which) {
+        switch(which) {
+            case BenchBus::I2C_ASYNC: return asyncLcd;
+            case BenchBus::SPI: return spiLcd;
+            case BenchBus::SERIAL: return serialLcd;
+            case BenchBus::MOCK: return mockLcd;
+            default: return i2cLcd;
+        }
+    }
+    
+    // Statistics of the bus under test
+    unsigned long busBytes() const {
+        switch(bus) {
+            case BenchBus::SPI: return SPI.bytesSent();
+            case BenchBus::SERIAL: return Serial1.bytesSent();
+            case BenchBus::MOCK: return link.bytesSent();
+            default: return Wire1.bytesSent();
+        }
+    }
+    unsigned long busTransactions() const {
+        switch(bus) {
+            case BenchBus::SPI: return SPI.transactions();
+            case BenchBus::SERIAL: return Serial1.transactions();
+            case BenchBus::MOCK: return link.transactions();
+            default: return Wire1.transactions();
+        }
+    }
+    void resetBusStats() {
+        Wire1.resetStats();
+        SPI.resetStats();
+        Serial1.resetStats();
+        link.resetStats();
+    }
+
+    // One pass of a sketch loop()
+    void step() {
+        unsigned long start = micros();
+        if(budget > 0) lcd.update(budget);
+        else lcd.update();
+        updateMicros += micros() - start;
+        updates++;
+        if(lcd.hasError() && !inError) {
+            resets++;                                // Queue dropped, display reinitialized
+        }
+        inError = lcd.hasError();
+        hostAdvanceMicros(LOOP_MICROS);
+    }
+
+    // Queue text at a position and remember when each accepted character was queued
+    void printAt(uint8_t col, uint8_t row, const char* text) {
+        lcd.setCursor(col, row);
+        size_t len = strlen(text);
+        size_t accepted = lcd.print(text);
+        latency.noteText(col, row, text, accepted);
+        rejected += len - accepted;
+    }
+
+    // Queue a backlight colour and remember when
+    void backlight(uint8_t r, uint8_t g, uint8_t b,
+                   SerLCD0::Priority priority = SerLCD0::Priority::NORMAL) {
+        lcd.setBacklight(r, g, b, priority);
+        latency.noteBacklight(r, g, b);
+    }
+
+    // Run loop passes until the queue is empty and the panel has caught up
+    void drain() {
+        unsigned long limit = micros() + DRAIN_LIMIT;
+        while(micros() < limit) {
+            step();
+            if(lcd.getQueueCount() == 0 && lcd.getUrgentCount() == 0 && lcd.isReady() &&
+               panel.busyUntil() <= micros()) {
+                step();                              // Let update() flush changed cells or fields
+                if(lcd.getQueueCount() == 0 && lcd.isReady()) break;
+            }
+        }
+    }
+};
+
+// Results of one workload at one bus speed
+struct BenchResult {
+    const char* name;
+    uint32_t clock;
+    double charsPerSecond;
+    unsigned long wireBytes;
+    unsigned long transactions;
+    unsigned long updates;
+    double updateMs;                                 // Time inside update()
+    double p50, p90, p99, max;
+    unsigned long lost;                              // Queued characters never shown
+    bool checked;                                    // Any lost character fails the run
+    unsigned long resets;                            // Forced reinitializations
+    unsigned long waitP50[4], waitP99[4];            // Library queue wait per command type (us)
+};
+
+static BenchResult finish(Bench& bench, const char* name, uint32_t clock) {
+    BenchResult result;
+    double seconds = (micros() - bench.startMicros) / 1000000.0;
+    result.name = name;
+    result.clock = clock;
+    result.charsPerSecond = seconds > 0 ? bench.panel.charsWritten() / seconds : 0;
+    result.wireBytes = bench.busBytes();
+    result.transactions = bench.busTransactions();
+    result.updates = bench.updates;
+    result.updateMs = bench.updateMicros / 1000.0;
+    result.p50 = bench.latency.percentile(50);
+    result.p90 = bench.latency.percentile(90);
+    result.p99 = bench.latency.percentile(99);
+    result.max = bench.latency.percentile(100);
+    result.lost = bench.rejected + bench.latency.lost();
+    result.checked = false;
+    result.resets = bench.resets;
+    for(uint8_t type = 0; type < 4; type++) {
+        LCDCommand::Type t = (LCDCommand::Type)(LCDCommand::WRITE_CHAR + type);
+        result.waitP50[type] = bench.lcd.getLatencyPercentile(t, 50);
+        result.waitP99[type] = bench.lcd.getLatencyPercentile(t, 99);
+    }
+    return result;
+}
+
+// Full-screen repaints, each queued as soon as the previous one fits
+static BenchResult benchRepaint(uint32_t clock, const BenchOptions& options) {
+    Bench bench(clock, options);
+    static const char* patterns[2][4] = {
+        { "ABCDEFGHIJKLMNOPQRST", "abcdefghijklmnopqrst", "01234567890123456789", "!@#$%^&*()-=+[]{};:," },
+        { "TSRQPONMLKJIHGFEDCBA", "tsrqponmlkjihgfedcba", "98765432109876543210", ",:;}{][+=-)(*&^%$#@!" },
+    };
+    for(int repaint = 0; repaint < 20; ) {
+        if(bench.lcd.getQueueFree() >= 4 * (2 + 20)) {
+            for(uint8_t row = 0; row < 4; row++) {
+                bench.printAt(0, row, patterns[repaint & 1][row]);
+            }
+            repaint++;
+        }
+        bench.step();
+    }
+    bench.drain();
+    return finish(bench, "repaint", clock);
+}
+
+// SerLCD0_Test.ino RUNNING state: time field and queue bar once a second for 30 s
+static BenchResult benchStatus(uint32_t clock, const BenchOptions& options) {
+    Bench bench(clock, options);
+    bench.printAt(0, 3, "Time: ");
+    for(unsigned long second = 1; second <= 30; second++) {
+        char text[12];
+        snprintf(text, sizeof(text), "%lus ", second);
+        bench.printAt(5, 3, text);
+        bench.printAt(12, 3, "|");
+        int barLength = (int)(bench.lcd.getQueuePercentFull() * 0.07);
+        char bar[8];
+        for(int i = 0; i < 7; i++) {
+            bar[i] = (i < barLength) ? '\xFF' : ' ';
+        }
+        bar[7] = '\0';
+        bench.printAt(13, 3, bar);
+
+        unsigned long next = bench.startMicros + second * 1000000UL;
+        while(micros() < next) {
+            bench.step();
+        }
+    }
+    bench.drain();
+    return finish(bench, "status", clock);
+}
+
+// Colour changes every millisecond for one second, like a flapping warning state
+static BenchResult benchBacklight(uint32_t clock, const BenchOptions& options) {
+    Bench bench(clock, options);
+    static const uint8_t colours[3][3] = { { 255, 255, 255 }, { 255, 140, 0 }, { 255, 0, 0 } };
+    for(int change = 0; change < 1000; change++) {
+        const uint8_t* c = colours[change % 3];
+        bench.backlight(c[0], c[1], c[2]);
+        unsigned long next = micros() + 1000;
+        while(micros() < next) {
+            bench.step();
+        }
+    }
+    bench.drain();
+    return finish(bench, "backlight", clock);
+}
+
+// A full clock screen repainted every 250 ms with an alarm colour change queued right
+// behind each repaint. Only the alarm is tracked, so the percentiles are alarm latency;
+// lost counts characters of the final screen that did not land where they were printed
+static BenchResult runAlarm(uint32_t clock, const BenchOptions& options, const char* name,
+                            SerLCD0::Priority priority) {
+    Bench bench(clock, options);
+    char line[4][21];
+    for(int tick = 0; tick < 40; tick++) {
+        for(uint8_t row = 0; row < 4; row++) {
+            snprintf(line[row], sizeof(line[row]), "Clock%d %02d:%02d.%03d  ", row, tick / 4, tick % 60,
+                     tick * 250 % 1000);
+            bench.lcd.setCursor(0, row);
+            bench.lcd.print(line[row]);
+        }
+        bench.backlight(255, (tick & 1) ? 255 : 0, (tick & 1) ? 255 : 0, priority);
+        unsigned long next = bench.startMicros + (tick + 1) * 250000UL;
+        while(micros() < next) {
+            bench.step();
+        }
+    }
+    bench.drain();
+    
+    BenchResult result = finish(bench, name, clock);
+    for(uint8_t row = 0; row < 4; row++) {
+        for(uint8_t col = 0; line[row][col] != '\0'; col++) {
+            if(bench.panel.charAt(col, row) != line[row][col]) result.lost++;
+        }
+    }
+    return result;
+}
+
+// Alarm colour in the normal lane, behind the repaint
+static BenchResult benchAlarm(uint32_t clock, const BenchOptions& options) {
+    return runAlarm(clock, options, "alarm", SerLCD0::Priority::NORMAL);
+}
+
+// Alarm colour in the urgent lane, ahead of the repaint
+static BenchResult benchUrgent(uint32_t clock, const BenchOptions& options) {
+    return runAlarm(clock, options, "urgent", SerLCD0::Priority::URGENT);
+}
+
+// Four 6 digit values refreshed every 5 ms for 5 s, faster than the display keeps up.
+// Printed directly, or set in field slots so only the latest value is sent
+static BenchResult runTelemetry(uint32_t clock, const BenchOptions& options, const char* name,
+                                bool fields) {
+    Bench bench(clock, options);
+    uint8_t ids[4];
+    for(uint8_t row = 0; row < 4; row++) {
+        ids[row] = fields ? bench.lcd.addField(8, row, 6) : SerLCD0::NO_FIELD;
+    }
+    char value[8];
+    for(int tick = 0; tick < 1000; tick++) {
+        for(uint8_t row = 0; row < 4; row++) {
+            snprintf(value, sizeof(value), "%6d", (tick * (row + 1) * 7) % 100000);
+            if(fields) {
+                bench.lcd.setField(ids[row], value);
+                bench.latency.noteText(8, row, value, 6);
+            } else {
+                bench.printAt(8, row, value);
+            }
+        }
+        unsigned long next = bench.startMicros + (tick + 1) * 5000UL;
+        while(micros() < next) {
+            bench.step();
+        }
+    }
+    bench.drain();
+    return finish(bench, name, clock);
+}
+
+// Telemetry printed with setCursor() and print()
+static BenchResult benchTelemetry(uint32_t clock, const BenchOptions& options) {
+    return runTelemetry(clock, options, "telemetry", false);
+}
+
+// Telemetry set in field slots
+static BenchResult benchFields(uint32_t clock, const BenchOptions& options) {
+    return runTelemetry(clock, options, "fields", true);
+}
+
+// 2000 characters offered in one burst, far beyond queue capacity
+static BenchResult benchOverflow(uint32_t clock, const BenchOptions& options) {
+    Bench bench(clock, options);
+    char line[21];
+    for(int i = 0; i < 100; i++) {
+        snprintf(line, sizeof(line), "Line %03d overflowing", i);
+        bench.printAt(0, i % 4, line);
+    }
+    bench.drain();
+    return finish(bench, "overflow", clock);
+}
+
+// Every character the panel receives, in order, against what the producer queued
+class StreamCheck {
+public:
+    // Record text the producer queued at a position
+    void expect(uint8_t col, uint8_t row, const char* text) {
+        for(size_t i = 0; text[i] != '\0'; i++) {
+            _expected.push_back(cell(col + i, row, (uint8_t)text[i]));
+        }
+    }
+    
+    // Emulator callback
+    static void onChar(void* context, uint8_t col, uint8_t row, uint8_t c, unsigned long /*visible*/) {
+        ((StreamCheck*)context)->_seen.push_back(cell(col, row, c));
+    }
+    
+    // Characters missing, out of place or wrong, plus any extra ones
+    unsigned long mismatches() const {
+        size_t common = std::min(_expected.size(), _seen.size());
+        unsigned long n = std::max(_expected.size(), _seen.size()) - common;
+        for(size_t i = 0; i < common; i++) {
+            if(_expected[i] != _seen[i]) n++;
+        }
+        return n;
+    }
+
+private:
+    static uint32_t cell(uint8_t col, uint8_t row, uint8_t c) {
+        return ((uint32_t)row << 16) | ((uint32_t)col << 8) | c;
+    }
+    std::vector<uint32_t> _expected;
+    std::vector<uint32_t> _seen;
+};
+
+// A second thread posts 2000 status fields through the lock-free queue while this
+// thread runs update(). Fields contain '|' (0x7C) so escaped frames cross the ring
+// wrap too. Any lost, reordered or torn command shows up as lost characters and fails
+// the run
+static BenchResult benchSpsc(uint32_t clock, const BenchOptions& options) {
+    Bench bench(clock, options);
+    StreamCheck check;
+    bench.panel.setObservers(StreamCheck::onChar, nullptr, &check);
+    bench.lcd.setQueueMode(SerLCD0::QueueMode::LOCK_FREE_SPSC);
+    
+    std::atomic<bool> done(false);
+    std::thread producer([&]() {
+        char text[8];
+        for(int i = 0; i < 2000; i++) {
+            uint8_t col = (i * 3) % 12;
+            uint8_t row = i % 4;
+            snprintf(text, sizeof(text), "|%05d|", i);
+            check.expect(col, row, text);
+            while(!bench.lcd.reserve(2 + 5 + 2 * 2)) {  // Cursor, digits, escaped bars
+                std::this_thread::yield();
+            }
+            bench.lcd.setCursor(col, row);
+            bench.lcd.print(text);
+        }
+        done = true;
+    });
+    while(!done || bench.lcd.getQueueCount() > 0) {
+        if(bench.lcd.getQueueCount() == 0) {
+            std::this_thread::yield();              // Simulated time waits for the producer
+            continue;
+        }
+        bench.step();
+    }
+    producer.join();
+    bench.drain();
+    
+    BenchResult result = finish(bench, "spsc", clock);
+    result.lost = check.mismatches();
+    result.checked = true;
+    return result;
+}
+
+// Whole fields from several producers, one row each. Fields may interleave with other
+// rows but each must reach the panel in one piece and in its producer's order
+class FieldCheck {
+public:
+    static const uint8_t FIELD_LEN = 7;
+    
+    // Record a field a producer queued, only that producer's thread touches its row
+    void expect(uint8_t col, uint8_t row, const char* text) {
+        for(uint8_t i = 0; i < FIELD_LEN; i++) {
+            _expected[row].push_back(cell(col + i, row, (uint8_t)text[i]));
+        }
+    }
+    
+    // Emulator callback
+    static void onChar(void* context, uint8_t col, uint8_t row, uint8_t c, unsigned long /*visible*/) {
+        ((FieldCheck*)context)->_seen.push_back(cell(col, row, c));
+    }
+    
+    // Characters of split, reordered or corrupted fields, plus missing or extra ones
+    unsigned long mismatches() const {
+        size_t next[OpenLCDEmulator::ROWS] = {};
+        size_t expected = 0;
+        unsigned long n = 0;
+        for(size_t i = 0; i < _seen.size(); i++) {
+            uint8_t row = (_seen[i - i % FIELD_LEN] >> 16) & 0x03;  // Row the field started on
+            const std::vector<uint32_t>& field = _expected[row];
+            if(next[row] >= field.size() || field[next[row]] != _seen[i]) n++;
+            next[row]++;
+        }
+        for(uint8_t row = 0; row < OpenLCDEmulator::ROWS; row++) {
+            expected += _expected[row].size();
+        }
+        return n + (expected > _seen.size() ? expected - _seen.size() : 0);
+    }
+
+private:
+    static uint32_t cell(uint8_t col, uint8_t row, uint8_t c) {
+        return ((uint32_t)row << 16) | ((uint32_t)col << 8) | c;
+    }
+    std::vector<uint32_t> _expected[OpenLCDEmulator::ROWS];
+    std::vector<uint32_t> _seen;
+};
+
+// Four threads each post 500 fields to their own row with writeField() through the
+// LOCKED_MPSC queue while this thread runs update(). A cursor move from one thread
+// landing between another's characters shows up as lost characters and fails the run
+static BenchResult benchMpsc(uint32_t clock, const BenchOptions& options) {
+    Bench bench(clock, options);
+    FieldCheck check;
+    bench.panel.setObservers(FieldCheck::onChar, nullptr, &check);
+    bench.lcd.setQueueMode(SerLCD0::QueueMode::LOCKED_MPSC);
+    
+    std::atomic<int> running(OpenLCDEmulator::ROWS);
+    std::vector<std::thread> producers;
+    for(uint8_t row = 0; row < OpenLCDEmulator::ROWS; row++) {
+        producers.emplace_back([&, row]() {
+            char text[FieldCheck::FIELD_LEN + 1];
+            for(int i = 0; i < 500; i++) {
+                uint8_t col = (i * 3) % 12;
+                snprintf(text, sizeof(text), "|%c%04d|", '0' + row, i % 10000);
+                check.expect(col, row, text);
+                while(!bench.lcd.writeField(col, row, text)) {
+                    std::this_thread::yield();      // Queue full, retry the whole field
+                }
+            }
+            running--;
+        });
+    }
+    while(running > 0 || bench.lcd.getQueueCount() > 0) {
+        if(bench.lcd.getQueueCount() == 0) {
+            std::this_thread::yield();              // Simulated time waits for the producers
+            continue;
+        }
+        bench.step();
+    }
+    for(std::thread& producer : producers) {
+        producer.join();
+    }
+    bench.drain();
+    
+    BenchResult result = finish(bench, "mpsc", clock);
+    result.lost = check.mismatches();
+    result.checked = true;
+    return result;
+}
+
+// How a multi-panel workload services its displays
+enum class PanelService { OWN_UPDATE, GROUP, MULTI_BUS };
+
+// Up to three panels, each repainted 10 times as fast as its queue allows. With one bus
+// they sit at 0x72-0x74 on Wire1, otherwise panel i is alone on Wire1, Wire2 or Wire.
+// Serviced by each display's own update() in turn, one SerLCD0Group, or a group per bus
+// under SerLCD0MultiBus. With --budget the budget is split evenly between displays, or
+// given whole to the group or coordinator. Always I2C (blocking, or asynchronous with
+// --bus i2c-async); there are no latency samples and lost counts characters of the
+// final screens not shown
+template<typename LCD>
+static BenchResult runPanels(uint32_t clock, const BenchOptions& options, const char* name,
+                             PanelService mode, uint8_t count, uint8_t buses) {
+    static const uint8_t MAX_PANELS = 3;
+    static const char* patterns[2][4] = {
+        { "ABCDEFGHIJKLMNOPQRST", "abcdefghijklmnopqrst", "01234567890123456789", "!@#$%^&*()-=+[]{};:," },
+        { "TSRQPONMLKJIHGFEDCBA", "tsrqponmlkjihgfedcba", "98765432109876543210", ",:;}{][+=-)(*&^%$#@!" },
+    };
+    TwoWire* ports[MAX_PANELS] = { &Wire1, &Wire2, &Wire };
+    TwoWire* port[MAX_PANELS];                       // Bus of each panel
+    uint8_t address[MAX_PANELS];                     // Address of each panel
+    for(uint8_t i = 0; i < MAX_PANELS; i++) {
+        port[i] = ports[i % buses];
+        address[i] = 0x72 + i / buses;
+    }
+    
+    hostSetMicros(0);
+    OpenLCDEmulator panels[MAX_PANELS];
+    LCD lcds[MAX_PANELS] = { { *port[0], address[0] }, { *port[1], address[1] },
+                             { *port[2], address[2] } };
+    SerLCD0Group groups[MAX_PANELS];
+    SerLCD0MultiBus multiBus;
+    for(uint8_t b = 0; b < buses; b++) {
+        ports[b]->setClock(clock);
+        ports[b]->resetStats();
+        multiBus.add(groups[b]);
+    }
+    for(uint8_t i = 0; i < count; i++) {
+        port[i]->attach(address[i], &panels[i]);
+        lcds[i].begin();
+        if(options.charTime >= 0) lcds[i].setCharTimeMicros(options.charTime);
+        if(options.cmdTime >= 0) lcds[i].setCmdTimeMicros(options.cmdTime);
+        groups[i % buses].add(lcds[i]);
+    }
+    
+    unsigned long updates = 0;
+    unsigned long updateMicros = 0;
+    auto step = [&]() {
+        unsigned long start = micros();
+        if(mode == PanelService::GROUP) {
+            if(options.budget > 0) groups[0].update(options.budget);
+            else groups[0].update();
+        } else if(mode == PanelService::MULTI_BUS) {
+            if(options.budget > 0) multiBus.update(options.budget);
+            else multiBus.update();
+        } else {
+            for(uint8_t i = 0; i < count; i++) {
+                if(options.budget > 0) lcds[i].update(options.budget / count);
+                else lcds[i].update();
+            }
+        }
+        updateMicros += micros() - start;
+        updates++;
+        hostAdvanceMicros(LOOP_MICROS);
+    };
+    auto drain = [&]() {
+        unsigned long limit = micros() + DRAIN_LIMIT;
+        while(micros() < limit) {
+            step();
+            bool idle = true;
+            for(uint8_t i = 0; i < count; i++) {
+                idle = idle && lcds[i].getQueueCount() == 0 && lcds[i].isReady() &&
+                       panels[i].busyUntil() <= micros();
+            }
+            if(idle) break;
+        }
+    };
+    drain();                                         // Initial clears and backlights
+    for(uint8_t b = 0; b < buses; b++) {
+        ports[b]->resetStats();
+    }
+    unsigned long startMicros = micros();
+    updates = 0;
+    updateMicros = 0;
+    
+    int repaints[MAX_PANELS] = {};
+    for(bool busy = true; busy; ) {
+        busy = false;
+        for(uint8_t i = 0; i < count; i++) {
+            if(repaints[i] >= 10) continue;
+            busy = true;
+            if(lcds[i].getQueueFree() >= 4 * (2 + 20)) {
+                for(uint8_t row = 0; row < 4; row++) {
+                    lcds[i].setCursor(0, row);
+                    lcds[i].print(patterns[repaints[i] & 1][row]);
+                }
+                repaints[i]++;
+            }
+        }
+        step();
+    }
+    drain();
+    
+    BenchResult result = {};
+    double seconds = (micros() - startMicros) / 1000000.0;
+    unsigned long chars = 0;
+    result.name = name;
+    result.clock = clock;
+    for(uint8_t i = 0; i < count; i++) {
+        chars += panels[i].charsWritten();
+        for(uint8_t row = 0; row < 4; row++) {
+            const char* line = patterns[(repaints[i] - 1) & 1][row];
+            for(uint8_t col = 0; line[col] != '\0'; col++) {
+                if(panels[i].charAt(col, row) != line[col]) result.lost++;
+            }
+        }
+        port[i]->detach(address[i]);
+    }
+    for(uint8_t b = 0; b < buses; b++) {
+        result.wireBytes += ports[b]->bytesSent();
+        result.transactions += ports[b]->transactions();
+    }
+    result.charsPerSecond = seconds > 0 ? chars / seconds : 0;
+    result.updates = updates;
+    result.updateMs = updateMicros / 1000.0;
+    return result;
+}
+
+// Multi-panel workload on the blocking or asynchronous I2C transport
+static BenchResult runPanels(uint32_t clock, const BenchOptions& options, const char* name,
+                             PanelService mode, uint8_t count, uint8_t buses) {
+    if(options.bus == BenchBus::I2C_ASYNC) {
+        return runPanels<BenchAsyncLCD>(clock, options, name, mode, count, buses);
+    }
+    return runPanels<BenchI2CLCD>(clock, options, name, mode, count, buses);
+}
+
+// Three panels on one bus, each display's own update()
+static BenchResult benchPanels(uint32_t clock, const BenchOptions& options) {
+    return runPanels(clock, options, "panels", PanelService::OWN_UPDATE, 3, 1);
+}
+
+// Three panels on one bus serviced by a SerLCD0Group
+static BenchResult benchGroup(uint32_t clock, const BenchOptions& options) {
+    return runPanels(clock, options, "group", PanelService::GROUP, 3, 1);
+}
+
+// One, two and three panels, each on its own bus, under SerLCD0MultiBus
+static BenchResult benchBuses1(uint32_t clock, const BenchOptions& options) {
+    return runPanels(clock, options, "buses1", PanelService::MULTI_BUS, 1, 1);
+}
+static BenchResult benchBuses2(uint32_t clock, const BenchOptions& options) {
+    return runPanels(clock, options, "buses2", PanelService::MULTI_BUS, 2, 2);
+}
+static BenchResult benchBuses3(uint32_t clock, const BenchOptions& options) {
+    return runPanels(clock, options, "buses3", PanelService::MULTI_BUS, 3, 3);
+}
+
+typedef BenchResult (*Workload)(uint32_t clock, const BenchOptions& options);
+
+static const struct {
+    const char* name;
+    Workload run;
+    bool i2cOnly;                                    // Drives Wire ports, skipped on other buses
+} workloads[] = {
+    { "repaint", benchRepaint, false },
+    { "status", benchStatus, false },
+    { "backlight", benchBacklight, false },
+    { "alarm", benchAlarm, false },
+    { "urgent", benchUrgent, false },
+    { "telemetry", benchTelemetry, false },
+    { "fields", benchFields, false },
+    { "overflow", benchOverflow, false },
+    { "spsc", benchSpsc, false },
+    { "mpsc", benchMpsc, false },
+    { "panels", benchPanels, true },
+    { "group", benchGroup, true },
+    { "buses1", benchBuses1, true },
+    { "buses2", benchBuses2, true },
+    { "buses3", benchBuses3, true },
+};
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    std::vector<uint32_t> clocks;
+    std::vector<const char*> selected;
+    for(int i = 1; i < argc; i++) {
+        if(strcmp(argv[i], "--shadow") == 0) options.shadow = true;
+        else if(strcmp(argv[i], "--budget") == 0 && i + 1 < argc) options.budget = strtoul(argv[++i], nullptr, 10);
+        else if(strcmp(argv[i], "--char-time") == 0 && i + 1 < argc) options.charTime = strtol(argv[++i], nullptr, 10);
+        else if(strcmp(argv[i], "--cmd-time") == 0 && i + 1 < argc) options.cmdTime = strtol(argv[++i], nullptr, 10);
+        else if(strcmp(argv[i], "--drop-oldest") == 0) options.dropOldest = true;
+        else if(strcmp(argv[i], "--bus") == 0 && i + 1 < argc) {
+            const char* bus = argv[++i];
+            if(strcmp(bus, "i2c-async") == 0) options.bus = BenchBus::I2C_ASYNC;
+            else if(strcmp(bus, "spi") == 0) options.bus = BenchBus::SPI;
+            else if(strcmp(bus, "serial") == 0) options.bus = BenchBus::SERIAL;
+            else if(strcmp(bus, "mock") == 0) options.bus = BenchBus::MOCK;
+            else options.bus = BenchBus::I2C;
+        }
+        else if(strcmp(argv[i], "--clock") == 0 && i + 1 < argc) clocks = { (uint32_t)strtoul(argv[++i], nullptr, 10) };
+        else selected.push_back(argv[i]);
+    }
+    if(clocks.empty()) {
+        switch(options.bus) {
+            case BenchBus::SPI: clocks = { 1000000, 4000000 }; break;
+            case BenchBus::SERIAL: clocks = { 9600, 115200 }; break;
+            case BenchBus::MOCK: clocks = { 0 }; break;
+            default: clocks = { 100000, 400000 }; break;
+        }
+    }
+    Serial.setOutput(nullptr);                       // Keep library debug output out of the table
+
+    printf("%-10s %6s %9s %8s %6s %8s %8s %8s %8s %8s %8s %7s %6s\n",
+           "workload", "kHz", "chars/s", "wire B", "xfers", "update()", "upd ms",
+           "p50 ms", "p90 ms", "p99 ms", "max ms", "lost", "resets");
+    int failures = 0;
+    for(const auto& workload : workloads) {
+        bool run = selected.empty();
+        for(const char* name : selected) {
+            if(strcmp(name, workload.name) == 0) run = true;
+        }
+        if(!run) continue;
+        if(workload.i2cOnly && options.bus != BenchBus::I2C && options.bus != BenchBus::I2C_ASYNC) {
+            printf("%-10s skipped, I2C only (--bus i2c or i2c-async)\n", workload.name);
+            continue;                                // Bus clocks would be meaningless for Wire
+        }
+
+        for(uint32_t clock : clocks) {
+            BenchResult r = workload.run(clock, options);
+            printf("%-10s %6.5g %9.0f %8lu %6lu %8lu %8.1f %8.2f %8.2f %8.2f %8.2f %7lu %6lu\n",
+                   r.name, r.clock / 1000.0, r.charsPerSecond, r.wireBytes,
+                   r.transactions, r.updates, r.updateMs, r.p50, r.p90, r.p99, r.max, r.lost, r.resets);
+            if(r.checked && r.lost > 0) {
+                printf("%-10s FAILED: %lu characters lost, reordered or torn\n", r.name, r.lost);
+                failures++;
+            }
+#if SERLCD0_LATENCY_STATS
+            // Bucket bounds from getLatencyPercentile(), - where none of a type was sent
+            static const char* types[4] = { "char", "special", "setting", "rgb" };
+            printf("%-10s queue wait p50/p99 ms:", "");
+            for(uint8_t type = 0; type < 4; type++) {
+                if(r.waitP99[type] == 0) printf("  %s -", types[type]);
+                else printf("  %s <%.3g/<%.3g", types[type], r.waitP50[type] / 1000.0, r.waitP99[type] / 1000.0);
+            }
+            printf("\n");
+#endif
+        }
+    }
+    return failures > 0 ? 1 : 0;                     // Nonzero when a checked workload lost text
+}
@@ -0,0 +1,49 @@
+// SerLCD0_HostSketch.cpp - Runs SerLCD0_Test.ino on the host against an emulated panel
+// Build and run from the library root (one command line):
+//   g++ -std=gnu++17 -I extras/host -I . -x c++ SerLCD0_Test.ino -x none SerLCD0.cpp
+//       extras/host/ArduinoHost.cpp extras/host/OpenLCDEmulator.cpp
+//       extras/host/SerLCD0_HostSketch.cpp -o serlcd0_sketch
+//   ./serlcd0_sketch [seconds] [-v]
+
+#include <stdlib.h>
+#include "Arduino.h"
+#include "Wire.h"
+#include "OpenLCDEmulator.h"
+
+// Sketch entry points
+void setup();
+void loop();
+
+static const unsigned long LOOP_MICROS = 50;     // Simulated cost of one loop() pass
+
+int main(int argc, char** argv) {
+    unsigned long seconds = 12;                  // Long enough to see warning states cycle
+    bool verbose = false;                        // Show the sketch's Serial output
+    for(int i = 1; i < argc; i++) {
+        if(strcmp(argv[i], "-v") == 0) verbose = true;
+        else seconds = strtoul(argv[i], nullptr, 10);
+    }
+    if(!verbose) {
+        Serial.setOutput(nullptr);
+    }
+    
+    // Panel on Wire1 at the default address, as in the sketch
+    OpenLCDEmulator panel;
+    Wire1.attach(0x72, &panel);
+    
+    setup();
+    while(micros() < seconds * 1000000UL) {
+        loop();
+        hostAdvanceMicros(LOOP_MICROS);
+    }
+    
+    printf("After %lu simulated seconds:\n", seconds);
+    panel.printScreen(stdout);
+    printf("I2C: %lu transactions, %lu bytes, bus busy %lu us\n",
+           Wire1.transactions(), Wire1.bytesSent(), Wire1.busMicros());
+    printf("Panel: %lu chars, %lu commands, %lu clears, %lu backlight changes, "
+           "%lu dropped bytes, max backlog %u\n",
+           panel.charsWritten(), panel.commands(), panel.clears(),
+           panel.backlightChanges(), panel.droppedBytes(), panel.maxBacklog());
+    return 0;
+}
@@ -0,0 +1,115 @@
+// SerLCD0_LogDecode.cpp - Turns the debug event lines SerLCD0 drains to Serial into text
+// Lines starting with "~" are decoded, everything else the sketch printed passes through,
+// so a captured Serial Monitor session or host sketch output can be fed in as it is
+// Build and run from the library root (one command line):
+//   g++ -std=gnu++17 -I extras/host -I . extras/host/SerLCD0_LogDecode.cpp -o serlcd0_logdecode
+//   ./serlcd0_logdecode [capture.txt ...]      (reads stdin without files)
+//   ./serlcd0_sketch 12 -v | ./serlcd0_logdecode
+
+#include <stdio.h>
+#include <string.h>
+#include "SerLCD0.h"
+
+// Category and message for each event id
+struct EventText {
+    uint8_t id;
+    const char* category;
+    const char* format;              // printf format, given a, b and c
+};
+
+static const EventText EVENTS[] = {
+    { SerLCD0Log::QUEUE_FULL,        "QUEUE",     "Queue full - %u byte command dropped" },
+    { SerLCD0Log::TEXT_TRUNCATED,    "QUEUE",     "Queue full - text truncated, %u characters dropped" },
+    { SerLCD0Log::BACKLIGHT_QUEUED,  "BACKLIGHT", "Backlight RGB(%u,%u,%u) queued" },
+    { SerLCD0Log::BACKLIGHT_REFUSED, "BACKLIGHT", "Backlight RGB(%u,%u,%u) failed to queue" },
+    { SerLCD0Log::BACKLIGHT_SENT,    "BACKLIGHT", "Setting backlight RGB(%u,%u,%u)" },
+    { SerLCD0Log::TRANSFER_TIMEOUT,  "BUS",       "Transfer of %u bytes timed out" },
+    { SerLCD0Log::TRANSFER_FAILED,   "BUS",       "Transmission of %u bytes failed" },
+    { SerLCD0Log::ERROR_COUNTED,     "RECOVERY",  "Error #%u in state: %s" },
+    { SerLCD0Log::ERROR_STATE,       "RECOVERY",  "ERROR state after %u errors - will reset" },
+    { SerLCD0Log::EVENTS_LOST,       "LOG",       "%u events lost, log ring full" },
+};
+
+// State numbers logged with ERROR_COUNTED, as getStateString() names them
+static const char* STATES[] = { "READY", "PROCESSING", "AWAITING_RESPONSE", "ERROR" };
+
+// Value of one hex digit, -1 if it is not one
+static int hexDigit(char c) {
+    if(c >= '0' && c <= '9') return c - '0';
+    if(c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if(c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+// Decode one "~" line into bytes, false if it is not an event line
+static bool parseEvent(const char* line, uint8_t bytes[8]) {
+    if(line[0] != '~') {
+        return false;
+    }
+    for(int i = 0; i < 8; i++) {
+        int high = hexDigit(line[1 + 2 * i]);
+        int low = high < 0 ? -1 : hexDigit(line[2 + 2 * i]);
+        if(low < 0) {
+            return false;
+        }
+        bytes[i] = (uint8_t)(high << 4 | low);
+    }
+    char end = line[17];
+    return end == '\0' || end == '\r' || end == '\n';
+}
+
+// Print one event as "seconds category message"
+static void printEvent(const uint8_t bytes[8]) {
+    unsigned long micros = (unsigned long)bytes[0] << 24 | (unsigned long)bytes[1] << 16 |
+                           (unsigned long)bytes[2] << 8 | bytes[3];
+    uint8_t id = bytes[4], a = bytes[5], b = bytes[6], c = bytes[7];
+    printf("%6lu.%06lu  ", micros / 1000000, micros % 1000000);
+
+    for(const EventText& event : EVENTS) {
+        if(event.id != id) {
+            continue;
+        }
+        printf("%-10s", event.category);
+        if(id == SerLCD0Log::ERROR_COUNTED) {
+            printf(event.format, a, b < 4 ? STATES[b] : "UNKNOWN");
+        } else {
+            printf(event.format, a, b, c);
+        }
+        if((id == SerLCD0Log::TEXT_TRUNCATED || id == SerLCD0Log::EVENTS_LOST) && a == 255) {
+            printf(" (or more)");
+        }
+        printf("\n");
+        return;
+    }
+    printf("%-10sUnknown event %u (%u,%u,%u)\n", "?", id, a, b, c);
+}
+
+// Decode one capture, passing other lines through
+static void decode(FILE* in) {
+    char line[512];
+    while(fgets(line, sizeof(line), in)) {
+        uint8_t bytes[8];
+        if(parseEvent(line, bytes)) {
+            printEvent(bytes);
+        } else {
+            fputs(line, stdout);
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    if(argc < 2) {
+        decode(stdin);
+        return 0;
+    }
+    for(int i = 1; i < argc; i++) {
+        FILE* in = fopen(argv[i], "r");
+        if(!in) {
+            fprintf(stderr, "Cannot open %s\n", argv[i]);
+            return 1;
+        }
+        decode(in);
+        fclose(in);
+    }
+    return 0;
+}
@@ -0,0 +1,82 @@
+// Wire.h - Host (Linux g++) stand-in for the Arduino TwoWire class
+// Transactions are delivered to attached TwoWireDevice objects and charge
+// simulated bus time: 9 bit clocks per byte (address included) plus start/stop
+
+#ifndef SERLCD0_HOST_WIRE_H
+#define SERLCD0_HOST_WIRE_H
+
+#include "Arduino.h"
+
+#define BUFFER_LENGTH 32                     // Wire TX buffer size (matches R4)
+
+// Device on the simulated bus
+class TwoWireDevice {
+public:
+    virtual ~TwoWireDevice() {}
+    
+    // Receive one write transaction; byteMicros is the bus time per byte and the
+    // first data byte completes at startMicros + 2 * byteMicros. Return false to NACK
+    virtual bool onReceive(const uint8_t* data, size_t len,
+                           unsigned long startMicros, unsigned long byteMicros) = 0;
+};
+
+class TwoWire {
+public:
+    void begin() {}
+    void end() {}
+    void setClock(uint32_t hz) { _clock = hz; }
+    uint32_t getClock() const { return _clock; }
+    
+    // Transmit interface used by SerLCD0
+    void beginTransmission(uint8_t address);
+    size_t write(uint8_t data);
+    size_t write(const uint8_t* data, size_t len);
+    uint8_t endTransmission(bool sendStop = true);
+    
+    // Non-blocking writes for SerLCD0AsyncI2CTransport
+    bool startWrite(uint8_t address, const uint8_t* data, uint8_t len);  // False while busy
+    int pollWrite();                                      // Negative while in flight
+    
+    // Simulation control
+    void attach(uint8_t address, TwoWireDevice* device);  // Connect device at address
+    void detach(uint8_t address);                         // Unplug device
+    void failNext(uint8_t count) { _failCount = count; }  // NACK next transactions
+    void stallNext(uint8_t count) { _stallCount = count; }  // Hang next startWrite() calls
+    unsigned long byteMicros() const;                     // Bus time per byte
+    
+    // Bus statistics
+    unsigned long transactions() const { return _transactions; }
+    unsigned long bytesSent() const { return _bytesSent; }
+    unsigned long busMicros() const { return _busMicros; }
+    void resetStats() { _transactions = 0; _bytesSent = 0; _busMicros = 0; }
+
+private:
+    static const uint8_t MAX_DEVICES = 8;
+    static const unsigned long STALL_MICROS = 500000;  // Bus held by a hung write
+    
+    uint8_t deliver(unsigned long start, unsigned long& duration);  // Send buffered transaction
+    
+    uint32_t _clock = 100000;                // Bus clock (Hz)
+    uint8_t _address = 0;                    // Current transaction address
+    uint8_t _buffer[BUFFER_LENGTH];          // Pending transaction bytes
+    uint8_t _length = 0;                     // Bytes in pending transaction
+    bool _overflow = false;                  // Write past buffer end
+    uint8_t _failCount = 0;                  // Forced NACKs remaining
+    uint8_t _stallCount = 0;                 // Forced hangs remaining
+    unsigned long _asyncStart = 0;           // Start of last startWrite()
+    unsigned long _asyncMicros = 0;          // Its bus time
+    uint8_t _asyncResult = 0;                // Its endTransmission() code
+    
+    uint8_t _addresses[MAX_DEVICES];         // Attached device addresses
+    TwoWireDevice* _devices[MAX_DEVICES] = {};  // Attached devices
+    
+    unsigned long _transactions = 0;
+    unsigned long _bytesSent = 0;
+    unsigned long _busMicros = 0;
+};
+
+extern TwoWire Wire;
+extern TwoWire Wire1;
+extern TwoWire Wire2;
+
+#endif